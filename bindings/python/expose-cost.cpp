@@ -40,6 +40,7 @@ void exposeCost() {
   using CostPtr = shared_ptr<Cost>;
   bp::register_ptr_to_python<CostPtr>();
 
+  Scalar (Cost::*call1)(const ConstVectorRef &) const = &Cost::call;
   void (Cost::*compGrad1)(const ConstVectorRef &, VectorRef) const =
       &Cost::computeGradient;
   void (Cost::*compHess1)(const ConstVectorRef &, MatrixRef) const =
@@ -53,7 +54,7 @@ void exposeCost() {
       "CostFunctionBase", bp::no_init)
       .def(bp::init<int, int>(bp::args("self", "nx", "ndx")))
       .def(bp::init<const Manifold &>(bp::args("self", "manifold")))
-      .def("call", bp::pure_virtual(&Cost::call), bp::args("self", "x"))
+      .def("call", bp::pure_virtual(call1), bp::args("self", "x"))
       .def("computeGradient", bp::pure_virtual(compGrad1),
            bp::args("self", "x", "gout"))
       .def("computeGradient", compGrad2, bp::args("self", "x"),
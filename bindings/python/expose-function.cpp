@@ -10,7 +10,9 @@ using context::C2Function;
 using context::ConstVectorRef;
 using context::Function;
 using context::Manifold;
+using context::MatrixRef;
 using context::Scalar;
+using context::VectorRef;
 
 void exposeFunctionOps();
 
@@ -29,6 +31,9 @@ void exposeFunctionTypes() {
 
   context::MatFuncType C1Function::*compJac1 = &C1Function::computeJacobian;
   context::MatFuncRetType C1Function::*compJac2 = &C1Function::computeJacobian;
+  void (C1Function::*compValJac)(const ConstVectorRef &, VectorRef, MatrixRef)
+      const = &C1Function::computeValueAndJacobian;
+  context::VHPFuncType C2Function::*vhp = &C2Function::vectorHessianProduct;
 
   bp::class_<C1FunctionWrap, bp::bases<Function>, boost::noncopyable>(
       "C1Function", "Base class for differentiable functions", bp::no_init)
@@ -38,7 +43,10 @@ void exposeFunctionTypes() {
       .def("computeJacobian", bp::pure_virtual(compJac1),
            bp::args("self", "x", "Jout"))
       .def("getJacobian", compJac2, bp::args("self", "x"),
-           "Compute and return Jacobian.");
+           "Compute and return Jacobian.")
+      .def("computeValueAndJacobian", compValJac,
+           bp::args("self", "x", "out", "Jout"),
+           "Evaluate the function and its Jacobian at the same point.");
 
   bp::register_ptr_to_python<shared_ptr<C2Function>>();
   bp::class_<C2FunctionWrap, bp::bases<C1Function>, boost::noncopyable>(
@@ -47,8 +55,8 @@ void exposeFunctionTypes() {
       .def(bp::init<const Manifold &, const int>(
           bp::args("self", "manifold", "nr")))
       .def(bp::init<int, int, int>(bp::args("self", "nx", "ndx", "nr")))
-      .def("vectorHessianProduct", &C2Function::vectorHessianProduct,
-           &C2FunctionWrap::default_vhp, bp::args("self", "x", "v", "Hout"))
+      .def("vectorHessianProduct", vhp, &C2FunctionWrap::default_vhp,
+           bp::args("self", "x", "v", "Hout"))
       .def("getVHP", &C2FunctionWrap::getVHP, bp::args("self", "x", "v"),
            "Compute and return the vector-Hessian product.")
       .def(
@@ -52,6 +52,32 @@ void exposeLdltRoutines() {
       .def(LDLTVisitor<BlockLDLT>())
       .def("print_sparsity", &BlockLDLT::print_sparsity, "self"_a,
            "Print the sparsity pattern of the matrix to factorize.");
+
+  using SparseLDLT = linalg::SparseLDLT<Scalar>;
+  bp::class_<SparseLDLT>("SparseLDLT",
+                         "Sparse LDLT with a reusable symbolic analysis.",
+                         bp::no_init)
+      .def(LDLTVisitor<SparseLDLT>())
+      .add_property("nnz", &SparseLDLT::nonZeros,
+                    "Number of nonzeros in the analyzed pattern.")
+      .add_property("num_analyses", &SparseLDLT::numAnalyses,
+                    "Number of symbolic analyses performed.");
+
+  using linalg::SymbolicAnalysisCache;
+  bp::class_<SymbolicAnalysisCache, boost::noncopyable>(
+      "SymbolicAnalysisCache",
+      "Process-wide cache of the block permutations used by BlockLDLT.",
+      bp::no_init)
+      .def("instance", &SymbolicAnalysisCache::instance,
+           bp::return_value_policy<bp::reference_existing_object>(),
+           "Get the global cache instance.")
+      .staticmethod("instance")
+      .def("save", &SymbolicAnalysisCache::save, ("self"_a, "filename"))
+      .def("load", &SymbolicAnalysisCache::load, ("self"_a, "filename"))
+      .def("clear", &SymbolicAnalysisCache::clear, "self"_a)
+      .def("__len__", &SymbolicAnalysisCache::size, "self"_a)
+      .add_property("enabled", &SymbolicAnalysisCache::enabled,
+                    &SymbolicAnalysisCache::setEnabled);
 #ifdef PROXSUITE_NLP_USE_PROXSUITE_LDLT
   using ProxSuiteLDLT = linalg::ProxSuiteLDLTWrapper<Scalar>;
   bp::class_<ProxSuiteLDLT>(
@@ -24,6 +24,10 @@ void exposeProblem() {
                     "Get the total dimension of the constraints.")
       .add_property("nx", &Problem::nx, "Get the problem tangent space dim.")
       .add_property("ndx", &Problem::ndx, "Get the problem tangent space dim.")
+      .add_property("num_threads", &Problem::getNumThreads,
+                    &Problem::setNumThreads,
+                    "Number of threads used to evaluate the constraint blocks "
+                    "(constraints defined in Python are not thread-safe).")
       .def("add_constraint", &Problem::addConstraint<const Constraint &>,
            bp::args("self", "cstr"), "Add a constraint to the problem.");
 }
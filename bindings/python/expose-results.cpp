@@ -1,6 +1,8 @@
 #include "proxsuite-nlp/python/fwd.hpp"
 #include "proxsuite-nlp/results.hpp"
 
+#include <eigenpy/std-vector.hpp>
+
 namespace proxsuite {
 namespace nlp {
 namespace python {
@@ -11,7 +13,30 @@ void exposeResults() {
   bp::enum_<ConvergenceFlag>("ConvergenceFlag", "Convergence flag enum.")
       .value("uninit", ConvergenceFlag::UNINIT)
       .value("success", ConvergenceFlag::SUCCESS)
-      .value("max_iters_reached", ConvergenceFlag::MAX_ITERS_REACHED);
+      .value("max_iters_reached", ConvergenceFlag::MAX_ITERS_REACHED)
+      .value("failed", ConvergenceFlag::FAILED);
+  eigenpy::StdVectorPythonVisitor<std::vector<ConvergenceFlag>, true>::expose(
+      "StdVec_ConvergenceFlag");
+
+  bp::class_<TimerStat>("TimerStat",
+                        "Cumulative wall-clock time and number of calls.",
+                        bp::no_init)
+      .def_readonly("total", &TimerStat::total, "Total time (in seconds).")
+      .def_readonly("count", &TimerStat::count, "Number of calls.")
+      .add_property("mean", &TimerStat::mean, "Mean time per call.");
+
+  bp::class_<SolverTimings>("SolverTimings",
+                            "Timings of the solver phases. Only filled in "
+                            "when built with ENABLE_TIMINGS.",
+                            bp::no_init)
+      .def_readonly("evaluation", &SolverTimings::evaluation)
+      .def_readonly("derivatives", &SolverTimings::derivatives)
+      .def_readonly("hessians", &SolverTimings::hessians)
+      .def_readonly("kkt_assembly", &SolverTimings::kkt_assembly)
+      .def_readonly("factorization", &SolverTimings::factorization)
+      .def_readonly("refinement", &SolverTimings::refinement)
+      .def_readonly("linesearch", &SolverTimings::linesearch)
+      .def(bp::self_ns::str(bp::self));
 
   bp::class_<Results>("Results", "Results holder struct.",
                       bp::init<context::Problem &>(bp::args("self", "problem")))
@@ -29,6 +54,7 @@ void exposeResults() {
       .def_readonly("prim_infeas", &Results::prim_infeas)
       .def_readonly("constraint_errs", &Results::constraint_violations,
                     "Constraint violations.")
+      .def_readonly("timings", &Results::timings)
       .def(bp::self_ns::str(bp::self));
 }
 
@@ -22,13 +22,15 @@ void exposeSolver() {
 
   bp::enum_<LinesearchStrategy>(
       "LinesearchStrategy",
-      "Linesearch strategy. Only Armijo linesearch is implemented for now.")
-      .value("ARMIJO", LinesearchStrategy::ARMIJO);
+      "Linesearch strategy.")
+      .value("ARMIJO", LinesearchStrategy::ARMIJO)
+      .value("WOLFE", LinesearchStrategy::WOLFE);
 
   bp::enum_<HessianApprox>("HessianApprox",
                            "Type of approximation of the Lagrangian Hessian.")
       .value("HESSIAN_EXACT", HessianApprox::EXACT)
       .value("HESSIAN_GAUSS_NEWTON", HessianApprox::GAUSS_NEWTON)
+      .value("HESSIAN_BFGS", HessianApprox::BFGS)
       .export_values();
 
   bp::enum_<MultiplierUpdateMode>("MultiplierUpdateMode",
@@ -50,6 +52,8 @@ void exposeSolver() {
       .value("LDLT_BLOCKSPARSE", LDLTChoice::BLOCKSPARSE)
       .value("LDLT_EIGEN", LDLTChoice::EIGEN)
       .value("LDLT_PROXSUITE", LDLTChoice::PROXSUITE)
+      .value("LDLT_SPARSE", LDLTChoice::SPARSE)
+      .value("LDLT_BLOCKTRIDIAG", LDLTChoice::BLOCKTRIDIAG)
       .export_values();
 
   using LinesearchOptions = Linesearch<Scalar>::Options;
@@ -123,6 +127,14 @@ void exposeSolver() {
                                 (bp::arg("self"), bp::arg("x0"),
                                  bp::arg("lams0") = context::VectorXs(0)),
                                 "Run the solver.")
+      .def("solveBatch", &ProxNLPSolver::solveBatch,
+           (bp::arg("self"), bp::arg("x0s"),
+            bp::arg("lams0s") = context::VectorOfVectors()),
+           "Solve a batch of instances of the problem from the given initial "
+           "guesses, in parallel (see batch_num_threads).")
+      .def("getBatchResults", &ProxNLPSolver::getBatchResults,
+           bp::args("self", "i"), bp::return_internal_reference<>(),
+           "Get the results of an instance of the last batch.")
       .def("setPenalty", &ProxNLPSolver::setPenalty, bp::args("self", "mu"),
            "Set the augmented Lagrangian penalty parameter.")
       .def("setDualPenalty", &ProxNLPSolver::setDualPenalty,
@@ -166,10 +178,38 @@ void exposeSolver() {
       .def_readwrite("max_al_iters", &ProxNLPSolver::max_al_iters,
                      "Max augmented Lagrangian iterations.")
       .def_readwrite("reg_init", &ProxNLPSolver::DELTA_INIT,
-                     "Initial regularization.");
+                     "Initial regularization.")
+      .def_readwrite("warm_start", &ProxNLPSolver::warm_start_,
+                     "Keep the penalty parameters, tolerances, regularization "
+                     "and multipliers across consecutive calls to solve().")
+      .def_readwrite("reduced_kkt", &ProxNLPSolver::reduced_kkt_,
+                     "Only factorize the KKT rows of the active constraints "
+                     "(set before setup()).")
+      .def_readwrite("accumulate_hessians",
+                     &ProxNLPSolver::accumulate_hessians_,
+                     "Sum the constraint vector-Hessian products into a "
+                     "single buffer (set before setup()).")
+      .def_readwrite("sparse_kkt", &ProxNLPSolver::sparse_kkt_,
+                     "Hold the derivatives and the KKT matrix in sparse "
+                     "storage, for LDLT_SPARSE (set before setup()).")
+      .add_property("ls_num_threads", &ProxNLPSolver::getLinesearchNumThreads,
+                    &ProxNLPSolver::setLinesearchNumThreads,
+                    "Number of step sizes evaluated concurrently by the "
+                    "Armijo linesearch (set before setup()). Functions "
+                    "implemented in Python cannot be evaluated concurrently.")
+      .add_property("ldlt_num_threads", &ProxNLPSolver::getLdltNumThreads,
+                    &ProxNLPSolver::setLdltNumThreads,
+                    "Number of threads of the dense and block-sparse KKT "
+                    "factorizations (set before setup()).")
+      .add_property("batch_num_threads", &ProxNLPSolver::getBatchNumThreads,
+                    &ProxNLPSolver::setBatchNumThreads,
+                    "Number of worker solvers of solveBatch() (set before "
+                    "setup()). Functions implemented in Python cannot be "
+                    "evaluated concurrently.");
   bp::enum_<KktSystem>("KktSystem")
       .value("KKT_CLASSIC", KKT_CLASSIC)
       .value("KKT_PRIMAL_DUAL", KKT_PRIMAL_DUAL)
+      .value("KKT_CONDENSED", KKT_CONDENSED)
       .export_values();
 
   bp::class_<BCLParams>("BCLParams",
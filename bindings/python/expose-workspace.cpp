@@ -13,10 +13,17 @@ void exposeWorkspace() {
       "Workspace", "ProxNLPSolverTpl workspace.",
       bp::init<const context::Problem &>(bp::args("self", "problem")))
       .def_readonly("kkt_matrix", &Workspace::kkt_matrix, "KKT matrix buffer.")
+      .def_readonly("sparse_kkt", &Workspace::sparse_kkt,
+                    "Whether the derivatives and the KKT matrix are held in "
+                    "sparse storage (the dense buffers are then empty).")
       .def_readonly("kkt_rhs", &Workspace::kkt_rhs,
                     "KKT system right-hand side buffer.")
       .def_readonly("kkt_err", &Workspace::kkt_err, "KKT system error.")
+      .def_readonly("kkt_condensed", &Workspace::kkt_condensed,
+                    "Condensed KKT matrix buffer (lower triangular part).")
       .def_readonly("pd_step", &Workspace::pd_step, "The primal-dual step.")
+      .def_readonly("delta_last", &Workspace::delta_last,
+                    "Last accepted inertia-correcting regularization.")
       .add_property("prim_step", bp::make_getter(&Workspace::prim_step,
                                                  policies::return_by_value))
       .add_property("dual_step", bp::make_getter(&Workspace::dual_step,
@@ -38,12 +45,16 @@ void exposeWorkspace() {
                     "Constraint Jacobians.")
       .def_readonly("data_hessians", &Workspace::data_hessians,
                     "Constraint vector-Hessian product matrices.")
+      .def_readonly("cstr_lagrangian_hessian",
+                    &Workspace::cstr_lagrangian_hessian,
+                    "Sum of the constraint vector-Hessian products (when "
+                    "accumulated).")
       .def_readonly("cstr_jacobians", &Workspace::cstr_jacobians,
                     "Block jacobians.")
-      .def_readonly("data_jacobians_proj", &Workspace::data_jacobians_proj,
-                    "Projected constraint Jacobians.")
-      .def_readonly("cstr_jacobians_proj", &Workspace::cstr_jacobians_proj,
-                    "Projected constraint Jacobians.")
+      .def_readonly("data_jac_proj_scale", &Workspace::data_jac_proj_scale,
+                    "Row scaling of the projected constraint Jacobians.")
+      .def_readonly("cstr_jac_proj_scale", &Workspace::cstr_jac_proj_scale,
+                    "Row scaling of the projected constraint Jacobians.")
       .def_readonly("lams_plus", &Workspace::lams_plus,
                     "First-order multiplier estimates.")
       .def_readonly("data_lams_plus", &Workspace::data_lams_plus,
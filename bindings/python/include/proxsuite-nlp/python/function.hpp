@@ -12,9 +12,10 @@ public:
 
   using context::Function::BaseFunctionTpl;
 
-  VectorXs operator()(const ConstVectorRef &x) const {
+  void evaluate(const ConstVectorRef &x, VectorRef out) const {
     bp::override f = get_override("__call__");
-    return f(x);
+    const VectorXs res = f(x);
+    out = res;
   }
 };
 
@@ -23,9 +24,10 @@ struct C1FunctionWrap : context::C1Function, bp::wrapper<context::C1Function> {
 
   using context::C1Function::C1FunctionTpl;
 
-  VectorXs operator()(const ConstVectorRef &x) const {
+  void evaluate(const ConstVectorRef &x, VectorRef out) const {
     bp::override f = get_override("__call__");
-    return f(x);
+    const VectorXs res = f(x);
+    out = res;
   }
 
   void computeJacobian(const ConstVectorRef &x, MatrixRef Jout) const {
@@ -39,9 +41,10 @@ struct C2FunctionWrap : context::C2Function, bp::wrapper<context::C2Function> {
 
   using context::C2Function::C2FunctionTpl;
 
-  VectorXs operator()(const ConstVectorRef &x) const {
+  void evaluate(const ConstVectorRef &x, VectorRef out) const {
     bp::override f = get_override("__call__");
-    return f(x);
+    const VectorXs res = f(x);
+    out = res;
   }
 
   void computeJacobian(const ConstVectorRef &x, MatrixRef Jout) const {
@@ -53,10 +53,10 @@ struct FramePosition : C2FunctionTpl<Scalar> {
 
   Model const &getModel() const { return space_->getModel(); }
 
-  VectorXs operator()(const ConstVectorRef &q) const override {
+  void evaluate(const ConstVectorRef &q, VectorRef out) const override {
     pin::forwardKinematics(getModel(), data_, q);
     pin::updateFramePlacement(getModel(), data_, fid_);
-    return data_.oMf[fid_].translation() - ref_;
+    out = data_.oMf[fid_].translation() - ref_;
   }
 
   void computeJacobian(const ConstVectorRef & /*q*/,
@@ -0,0 +1,331 @@
+/// @file
+/// @copyright Copyright (C) 2024 LAAS-CNRS, INRIA
+/// @brief     Lockstep solver for batches of instances of a small problem.
+#pragma once
+
+#include "proxsuite-nlp/prox-solver.hpp"
+
+namespace proxsuite {
+namespace nlp {
+
+/// @brief Struct-of-arrays storage of the lanes of BatchedSolverTpl.
+/// @details A quantity of dimension \f$ k \f$ is stored as a @p Lanes x
+/// \f$ k \f$ array, each column holding one coefficient for all the lanes, so
+/// that the lane-wise arithmetic is vectorized. Square matrices of dimension
+/// \f$ n \f$ have their coefficient \f$ (i, j) \f$ in column \f$ i + jn \f$,
+/// and the stacked constraint Jacobian (with \f$ m \f$ rows) has its
+/// coefficient \f$ (k, j) \f$ in column \f$ k + jm \f$. The points on the
+/// manifold and the function data are only used by the evaluations, and stay
+/// in the data of each lane.
+template <typename Scalar, int Lanes> struct BatchedWorkspaceTpl {
+  PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
+  using LaneArray = Eigen::Array<Scalar, Lanes, 1>;
+  using LaneMask = Eigen::Array<bool, Lanes, 1>;
+  using LaneMatrix = Eigen::Array<Scalar, Lanes, Eigen::Dynamic>;
+  using Problem = ProblemTpl<Scalar>;
+  using Workspace = WorkspaceTpl<Scalar>;
+  using Results = ResultsTpl<Scalar>;
+  using Merit = ALMeritFunctionTpl<Scalar>;
+  using ProxPenalty = QuadraticDistanceCostTpl<Scalar>;
+
+  /// Evaluation data of a single lane.
+  struct Lane {
+    /// Copy of the problem, whose constraint sets hold the penalty parameter
+    /// of the lane.
+    shared_ptr<Problem> problem;
+    /// Function data, derivatives, trial point and previous (outer)
+    /// iterates; the KKT systems are assembled in the BatchedWorkspaceTpl.
+    Workspace ws;
+    Merit merit;
+    ProxPenalty prox_penalty;
+    /// Lagrangian Hessian, including the proximal term.
+    MatrixXs hessian;
+    /// Results of the instance solved in the lane, null if the lane is unused.
+    Results *results = nullptr;
+
+    Lane(shared_ptr<Problem> prob, const Scalar &beta)
+        : problem(prob), ws(*prob, typename Workspace::EvaluationTag()),
+          merit(*prob, beta),
+          prox_penalty(prob->manifold_, prob->manifold_->neutral(),
+                       MatrixXs::Zero(prob->ndx(), prob->ndx())),
+          hessian(prob->ndx(), prob->ndx()) {}
+  };
+
+  long ndx;
+  long numdual;
+  std::vector<unique_ptr<Lane>> lanes;
+
+  //// Derivatives and multiplier estimates at the iterates
+
+  LaneMatrix gradient;
+  LaneMatrix prox_gradient;
+  LaneMatrix hessian;
+  LaneMatrix jacobian;
+  LaneMatrix lams;
+  LaneMatrix lams_plus;
+  LaneMatrix lams_plus_reproj;
+  LaneMatrix lams_pdal;
+  /// Row scaling of the projected constraint Jacobian.
+  LaneMatrix jac_scale;
+
+  //// Newton system
+
+  /// Lagrangian gradient \f$ \nabla f + J^\top \lambda \f$.
+  LaneMatrix dual_residual;
+  LaneMatrix rhs_prim;
+  LaneMatrix rhs_dual;
+  /// Lower triangular part of the condensed KKT matrix
+  /// \f$ H + \mu^{-1} J^\top S^2 J \f$.
+  LaneMatrix kkt_condensed;
+  /// Cholesky factor of the regularized condensed KKT matrix.
+  LaneMatrix llt_factor;
+  LaneMatrix prim_step;
+  LaneMatrix dual_step;
+  LaneMatrix tmp_prim;
+  LaneMatrix tmp_dual;
+
+  //// Per-lane parameters and criteria
+
+  LaneArray mu;
+  LaneArray mu_inv;
+  LaneArray rho;
+  LaneArray inner_tol;
+  LaneArray prim_tol;
+  LaneArray delta;
+  LaneArray delta_last;
+  LaneArray merit;
+  LaneArray dmerit_dir;
+  LaneArray alpha;
+  LaneArray merit_trial;
+  LaneArray prim_infeas;
+  LaneArray dual_infeas;
+  LaneArray inner_crit;
+  /// Lanes whose instance is still being solved.
+  LaneMask active;
+
+  /// @param beta  Dual weight of the merit function, which is referenced.
+  BatchedWorkspaceTpl(const Problem &prob, const Scalar &beta)
+      : ndx(prob.ndx()), numdual(prob.getTotalConstraintDim()) {
+    for (int l = 0; l < Lanes; l++)
+      lanes.push_back(std::make_unique<Lane>(prob.clone(), beta));
+    gradient.setZero(Lanes, ndx);
+    prox_gradient.setZero(Lanes, ndx);
+    hessian.setZero(Lanes, ndx * ndx);
+    jacobian.setZero(Lanes, numdual * ndx);
+    lams.setZero(Lanes, numdual);
+    lams_plus.setZero(Lanes, numdual);
+    lams_plus_reproj.setZero(Lanes, numdual);
+    lams_pdal.setZero(Lanes, numdual);
+    jac_scale.setZero(Lanes, numdual);
+    dual_residual.setZero(Lanes, ndx);
+    rhs_prim.setZero(Lanes, ndx);
+    rhs_dual.setZero(Lanes, numdual);
+    kkt_condensed.setZero(Lanes, ndx * ndx);
+    llt_factor.setZero(Lanes, ndx * ndx);
+    prim_step.setZero(Lanes, ndx);
+    dual_step.setZero(Lanes, numdual);
+    tmp_prim.setZero(Lanes, ndx);
+    tmp_dual.setZero(Lanes, numdual);
+    mu.setOnes();
+    mu_inv.setOnes();
+    rho.setZero();
+    inner_tol.setZero();
+    prim_tol.setZero();
+    delta.setZero();
+    delta_last.setZero();
+    merit.setZero();
+    dmerit_dir.setZero();
+    alpha.setZero();
+    merit_trial.setZero();
+    prim_infeas.setZero();
+    dual_infeas.setZero();
+    inner_crit.setZero();
+    active.setConstant(false);
+  }
+};
+
+/// @brief Solver for batches of instances of a small problem (e.g. with
+/// \f$ n_{dx} \leq 12 \f$) which only differ by their initial guess, running
+/// packs of @p Lanes instances in lockstep.
+///
+/// @details The problem functions, manifold operations and constraint set
+/// operators are evaluated lane by lane. Everything else is computed on the
+/// struct-of-arrays storage of BatchedWorkspaceTpl, vectorized over the lanes:
+/// the condensed KKT systems and their Cholesky factorizations, the merit
+/// function derivatives, the Armijo conditions and step sizes, and the BCL
+/// updates of the penalty parameters and tolerances. Each lane follows the
+/// iterations of ProxNLPSolverTpl with KKT_CONDENSED, the Armijo linesearch and
+/// MultiplierUpdateMode::NEWTON. The lanes needing another inertia-correcting
+/// regularization, a shorter step or a BCL update are selected by masks, and
+/// the lanes which are done are masked out until the whole pack is.
+///
+/// Unlike ProxNLPSolverTpl, the steps are not iteratively refined, the
+/// linesearch only supports the quadratic and bisection interpolations, and a
+/// lane whose inertia cannot be corrected stops with ConvergenceFlag::FAILED
+/// (ProxNLPSolverTpl keeps iterating with the largest regularization). The
+/// BFGS approximation is not supported. The unsupported settings are rejected
+/// by the constructors and setup().
+template <typename _Scalar, int Lanes> class BatchedSolverTpl {
+public:
+  static_assert(Lanes > 0, "The number of lanes should be positive.");
+  using Scalar = _Scalar;
+  PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
+  using Problem = ProblemTpl<Scalar>;
+  using Workspace = BatchedWorkspaceTpl<Scalar, Lanes>;
+  using Results = ResultsTpl<Scalar>;
+  using LinesearchOptions = typename Linesearch<Scalar>::Options;
+  using LaneArray = typename Workspace::LaneArray;
+  using LaneMask = typename Workspace::LaneMask;
+  using LaneMatrix = typename Workspace::LaneMatrix;
+  using Lane = typename Workspace::Lane;
+  using ConstraintSet = ConstraintSetBase<Scalar>;
+
+  shared_ptr<Problem> problem_;
+
+  /// Hessian approximation (BFGS is not supported).
+  HessianApprox hess_approx = HessianApprox::GAUSS_NEWTON;
+
+  Scalar inner_tol0 = 1.;
+  Scalar prim_tol0 = 1.;
+  Scalar rho_init_; //< Initial primal proximal penalty parameter.
+  Scalar mu_init_;  //< Initial penalty parameter.
+  Scalar inner_tol_min = 1e-9; //< Lower safeguard for the subproblem tolerance.
+  Scalar mu_upper_ = 1.;       //< Upper safeguard for the penalty parameter.
+  Scalar mu_lower_;            //< Lower safeguard for the penalty parameter.
+  Scalar pdal_beta_ = 0.5;     //< primal-dual weight for the dual variables.
+
+  /// BCL strategy parameters.
+  BCLParamsTpl<Scalar> bcl_params;
+
+  /// Linesearch options (the cubic interpolation is not supported).
+  LinesearchOptions ls_options;
+
+  /// Target tolerance for the problem.
+  Scalar target_tol;
+
+  //// Parameters for the inertia-correcting strategy.
+
+  const Scalar del_inc_k = 8.;
+  const Scalar del_inc_big = 100.;
+  const Scalar del_dec_k = 1. / 3.;
+
+  const Scalar DELTA_MIN = 1e-14; // Minimum nonzero regularization strength.
+  const Scalar DELTA_MAX = 1e6;   // Maximum regularization strength.
+  const Scalar DELTA_NONZERO_INIT = 1e-4;
+  Scalar DELTA_INIT = 0.;
+
+  /// Solver maximum number of iterations.
+  std::size_t max_iters = 100;
+  std::size_t max_al_iters = 1000;
+
+  unique_ptr<Workspace> workspace_;
+
+  BatchedSolverTpl(
+      shared_ptr<Problem> prob, const Scalar tol = 1e-6,
+      const Scalar mu_init = 1e-2, const Scalar rho_init = 0.,
+      const Scalar mu_lower = 1e-9,
+      const LinesearchOptions ls_options = defaultLinesearchOptions())
+      : problem_(prob), rho_init_(rho_init), mu_init_(mu_init),
+        mu_lower_(mu_lower), ls_options(ls_options), target_tol(tol) {
+    checkSettings();
+  }
+
+  /// @brief Solver whose lanes follow the iterations of @p solver, with its
+  /// problem and settings.
+  /// @details Throws if @p solver does not use KKT_CONDENSED without
+  /// iterative refinement, the Armijo linesearch and
+  /// MultiplierUpdateMode::NEWTON, or uses settings which are not supported
+  /// by this solver.
+  explicit BatchedSolverTpl(const ProxNLPSolverTpl<Scalar> &solver);
+
+  /// Linesearch options of the default constructor, with the quadratic
+  /// interpolation.
+  static LinesearchOptions defaultLinesearchOptions() {
+    LinesearchOptions opts;
+    opts.interp_type = LSInterpolation::QUADRATIC;
+    return opts;
+  }
+
+  /// Allocate the workspace, with a copy of the problem for each lane.
+  void setup() {
+    checkSettings();
+    workspace_ = std::make_unique<Workspace>(*problem_, pdal_beta_);
+  }
+
+  /**
+   * @brief Solve instances of the problem which only differ by their initial
+   * guess, by packs of @p Lanes instances run in lockstep.
+   *
+   * @param x0s    Initial guesses.
+   * @param lams0s Initial stacked Lagrange multipliers of each instance. If
+   * empty, the multipliers are set to zero.
+   * @returns The convergence flag of each instance, ConvergenceFlag::FAILED
+   * if an evaluation threw. Its results are given by getResults().
+   */
+  std::vector<ConvergenceFlag> solve(const std::vector<VectorXs> &x0s,
+                                     const std::vector<VectorXs> &lams0s = {});
+
+  /// Results of instance @p i of the last call to solve().
+  const Results &getResults(const std::size_t i) const {
+    return *results_.at(i);
+  }
+
+protected:
+  /// Results of the instances of the last call to solve().
+  std::vector<unique_ptr<Results>> results_;
+
+  /// Throw if the settings are not supported by this solver.
+  void checkSettings() const;
+
+  /// Solve the instances of the lanes which have results, in lockstep.
+  void solvePack(Workspace &workspace);
+
+  /// Evaluate the problem data, multiplier estimates and derivatives at the
+  /// iterate of lane @p l, and store them in the lane arrays.
+  void evaluateLane(Workspace &workspace, const int l) const;
+
+  /// Multiplier estimates of lane @p l (see
+  /// ProxNLPSolverTpl::computeMultipliers()).
+  void computeLaneMultipliers(Workspace &workspace, const int l,
+                              const ConstVectorRef &inner_lams_data) const;
+
+  /// Trial point of lane @p l for the step size @p alpha.
+  void tryStep(Workspace &workspace, const int l, const Scalar alpha) const;
+
+  /// Merit function (with the proximal term) of lane @p l at step size
+  /// @p alpha.
+  Scalar evaluateTrialMerit(Workspace &workspace, const int l,
+                            const Scalar alpha) const;
+
+  /// Lagrangian gradients, right-hand sides and stopping criteria.
+  void computeResiduals(Workspace &workspace) const;
+
+  /// BCL update of the lanes in @p mask, whose subproblem is solved.
+  void updateOuter(Workspace &workspace, const LaneMask &mask) const;
+
+  /// Newton steps of the lanes in @p mask, with the inertia correction.
+  /// Returns the lanes whose inertia could be corrected.
+  LaneMask computeStep(Workspace &workspace, const LaneMask &mask) const;
+
+  /// Cholesky factorization of the condensed KKT matrices, regularized by
+  /// BatchedWorkspaceTpl::delta. Returns the lanes for which it succeeded,
+  /// i.e. the KKT matrix has the correct inertia.
+  LaneMask factorizeCondensed(Workspace &workspace) const;
+
+  /// Armijo linesearch of the lanes in @p mask. The accepted step size of
+  /// each lane ends up in BatchedWorkspaceTpl::alpha.
+  void linesearch(Workspace &workspace, const LaneMask &mask) const;
+
+  /// Set the penalty parameters of the lanes in @p mask.
+  void setPenalty(Workspace &workspace, const LaneMask &mask,
+                  const LaneArray &new_mu) const;
+
+  /// Set the proximal parameters of the lanes in @p mask.
+  void setProxParameter(Workspace &workspace, const LaneMask &mask,
+                        const LaneArray &new_rho) const;
+};
+
+} // namespace nlp
+} // namespace proxsuite
+
+#include "proxsuite-nlp/batched-solver.hxx"
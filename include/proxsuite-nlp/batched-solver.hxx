@@ -0,0 +1,658 @@
+/// @file
+/// @copyright Copyright (C) 2024 LAAS-CNRS, INRIA
+/// @brief     Implementations for the batched solver.
+#pragma once
+
+#include "proxsuite-nlp/batched-solver.hpp"
+
+#include <limits>
+
+namespace proxsuite {
+namespace nlp {
+namespace internal {
+
+/// Copy a vector or column-major matrix into row @p l of a lane matrix.
+template <typename LaneMatrix, typename Derived>
+void setLane(LaneMatrix &out, const int l,
+             const Eigen::MatrixBase<Derived> &src) {
+  using RowVector = Eigen::Matrix<typename Derived::Scalar, 1, Eigen::Dynamic>;
+  out.row(l) =
+      Eigen::Map<const RowVector>(src.derived().data(), src.size()).array();
+}
+
+/// Copy row @p l of a lane matrix into a vector.
+template <typename LaneMatrix, typename Derived>
+void getLane(const LaneMatrix &in, const int l,
+             const Eigen::MatrixBase<Derived> &dst) {
+  using RowVector = Eigen::Matrix<typename Derived::Scalar, 1, Eigen::Dynamic>;
+  Derived &dst_ = const_cast<Derived &>(dst.derived());
+  Eigen::Map<RowVector>(dst_.data(), dst_.size()) = in.row(l).matrix();
+}
+
+/// Lane-wise infinity norm of the rows of a lane matrix.
+template <typename Derived>
+Eigen::Array<typename Derived::Scalar, Derived::RowsAtCompileTime, 1>
+laneInftyNorm(const Eigen::ArrayBase<Derived> &m) {
+  Eigen::Array<typename Derived::Scalar, Derived::RowsAtCompileTime, 1> out;
+  out.setZero();
+  for (Eigen::Index k = 0; k < m.cols(); k++)
+    out = out.max(m.col(k).abs());
+  return out;
+}
+
+/// Lane-wise dot product of the rows of two lane matrices.
+template <typename Derived>
+Eigen::Array<typename Derived::Scalar, Derived::RowsAtCompileTime, 1>
+laneDot(const Eigen::ArrayBase<Derived> &a,
+        const Eigen::ArrayBase<Derived> &b) {
+  Eigen::Array<typename Derived::Scalar, Derived::RowsAtCompileTime, 1> out;
+  out.setZero();
+  for (Eigen::Index k = 0; k < a.cols(); k++)
+    out += a.col(k) * b.col(k);
+  return out;
+}
+
+/// Lane-wise product \f$ out \mathrel{+}= J^\top v \f$.
+template <typename LaneMatrix>
+void addJacobianTransposeProduct(const LaneMatrix &jac, const LaneMatrix &v,
+                                 LaneMatrix &out) {
+  const Eigen::Index nr = v.cols();
+  for (Eigen::Index j = 0; j < out.cols(); j++)
+    for (Eigen::Index k = 0; k < nr; k++)
+      out.col(j) += jac.col(k + j * nr) * v.col(k);
+}
+
+/// Lane-wise product \f$ out \mathrel{+}= J v \f$.
+template <typename LaneMatrix>
+void addJacobianProduct(const LaneMatrix &jac, const LaneMatrix &v,
+                        LaneMatrix &out) {
+  const Eigen::Index nr = out.cols();
+  for (Eigen::Index j = 0; j < v.cols(); j++)
+    for (Eigen::Index k = 0; k < nr; k++)
+      out.col(k) += jac.col(k + j * nr) * v.col(j);
+}
+
+} // namespace internal
+
+template <typename Scalar, int Lanes>
+BatchedSolverTpl<Scalar, Lanes>::BatchedSolverTpl(
+    const ProxNLPSolverTpl<Scalar> &solver)
+    : BatchedSolverTpl(solver.problem_, solver.target_tol, solver.mu_init_,
+                       solver.rho_init_, solver.mu_lower_, solver.ls_options) {
+  if (solver.kkt_system_ != KKT_CONDENSED)
+    PROXSUITE_NLP_RUNTIME_ERROR(
+        "The batched solver only supports the KKT_CONDENSED system.");
+  if (solver.max_refinement_steps_ > 0)
+    PROXSUITE_NLP_RUNTIME_ERROR("The batched solver does not refine the "
+                                "steps: set max_refinement_steps_ to zero.");
+  if (solver.ls_strat != LinesearchStrategy::ARMIJO)
+    PROXSUITE_NLP_RUNTIME_ERROR(
+        "The batched solver only supports the Armijo linesearch.");
+  if (solver.mul_update_mode != MultiplierUpdateMode::NEWTON)
+    PROXSUITE_NLP_RUNTIME_ERROR("The batched solver only supports the NEWTON "
+                                "multiplier update mode.");
+  hess_approx = solver.hess_approx;
+  inner_tol0 = solver.inner_tol0;
+  prim_tol0 = solver.prim_tol0;
+  inner_tol_min = solver.inner_tol_min;
+  mu_upper_ = solver.mu_upper_;
+  pdal_beta_ = solver.pdal_beta_;
+  bcl_params = solver.bcl_params;
+  DELTA_INIT = solver.DELTA_INIT;
+  max_iters = solver.max_iters;
+  max_al_iters = solver.max_al_iters;
+  checkSettings();
+}
+
+template <typename Scalar, int Lanes>
+void BatchedSolverTpl<Scalar, Lanes>::checkSettings() const {
+  if (hess_approx == HessianApprox::BFGS)
+    PROXSUITE_NLP_RUNTIME_ERROR(
+        "The batched solver does not support the BFGS approximation.");
+  if (ls_options.interp_type == LSInterpolation::CUBIC)
+    PROXSUITE_NLP_RUNTIME_ERROR("The batched solver does not support the cubic "
+                                "linesearch interpolation.");
+}
+
+template <typename Scalar, int Lanes>
+std::vector<ConvergenceFlag>
+BatchedSolverTpl<Scalar, Lanes>::solve(const std::vector<VectorXs> &x0s,
+                                       const std::vector<VectorXs> &lams0s) {
+  if (workspace_ == nullptr) {
+    PROXSUITE_NLP_RUNTIME_ERROR(
+        "Workspace is uninitialized. Call setup() first.");
+  }
+  const std::size_t num_instances = x0s.size();
+  if (!lams0s.empty() && (lams0s.size() != num_instances)) {
+    PROXSUITE_NLP_RUNTIME_ERROR(
+        "Specified number of initial multipliers is not the same as the "
+        "number of initial guesses!");
+  }
+  Workspace &workspace = *workspace_;
+  // keep the results allocated from previous batches
+  results_.resize(num_instances);
+  for (auto &res : results_) {
+    if (res == nullptr)
+      res = std::make_unique<Results>(*problem_);
+  }
+
+  std::vector<ConvergenceFlag> flags(num_instances, ConvergenceFlag::UNINIT);
+  for (std::size_t start = 0; start < num_instances; start += Lanes) {
+    for (int l = 0; l < Lanes; l++) {
+      const std::size_t i = start + std::size_t(l);
+      Lane &lane = *workspace.lanes[std::size_t(l)];
+      lane.results = i < num_instances ? results_[i].get() : nullptr;
+      if (lane.results == nullptr)
+        continue;
+      lane.results->x_opt = x0s[i];
+      if (!lams0s.empty() && (lams0s[i].size() == workspace.numdual))
+        lane.results->data_lams_opt = lams0s[i];
+      else
+        lane.results->data_lams_opt.setZero();
+    }
+    solvePack(workspace);
+    for (std::size_t i = start; i < std::min(start + Lanes, num_instances);
+         i++)
+      flags[i] = results_[i]->converged;
+  }
+  return flags;
+}
+
+template <typename Scalar, int Lanes>
+void BatchedSolverTpl<Scalar, Lanes>::solvePack(Workspace &workspace) {
+  for (int l = 0; l < Lanes; l++)
+    workspace.active(l) = workspace.lanes[std::size_t(l)]->results != nullptr;
+  const LaneMask used = workspace.active;
+  setPenalty(workspace, used, LaneArray::Constant(mu_init_));
+  setProxParameter(workspace, used, LaneArray::Constant(rho_init_));
+  workspace.delta_last.setZero();
+  for (int l = 0; l < Lanes; l++) {
+    if (!used(l))
+      continue;
+    Lane &lane = *workspace.lanes[std::size_t(l)];
+    Results &results = *lane.results;
+    lane.ws.x_prev = results.x_opt;
+    lane.ws.data_lams_prev = results.data_lams_opt;
+    lane.prox_penalty.updateTarget(lane.ws.x_prev);
+    results.converged = ConvergenceFlag::UNINIT;
+    results.timings.reset();
+    results.num_iters = 0;
+    results.al_iters = 0;
+  }
+  workspace.prim_tol = prim_tol0 * workspace.mu.pow(bcl_params.prim_alpha);
+  workspace.inner_tol = inner_tol0 * workspace.mu.pow(bcl_params.dual_alpha);
+  workspace.inner_tol = workspace.inner_tol.max(inner_tol_min);
+  workspace.prim_tol = workspace.prim_tol.max(target_tol);
+
+  while (workspace.active.any()) {
+    for (int l = 0; l < Lanes; l++) {
+      if (!workspace.active(l))
+        continue;
+      Results &results = *workspace.lanes[std::size_t(l)]->results;
+      results.mu = workspace.mu(l);
+      results.rho = workspace.rho(l);
+      try {
+        evaluateLane(workspace, l);
+      } catch (const std::exception &) {
+        results.converged = ConvergenceFlag::FAILED;
+        workspace.active(l) = false;
+      }
+    }
+    computeResiduals(workspace);
+    for (int l = 0; l < Lanes; l++) {
+      if (workspace.active(l))
+        workspace.lanes[std::size_t(l)]->results->dual_infeas =
+            workspace.dual_infeas(l);
+    }
+
+    // lanes whose subproblem is solved take the outer (BCL) update
+    const LaneArray outer_crit =
+        workspace.prim_infeas.max(workspace.dual_infeas);
+    const LaneMask inner_done =
+        workspace.active && ((workspace.inner_crit <= workspace.inner_tol) ||
+                             (outer_crit <= target_tol));
+    updateOuter(workspace, inner_done);
+
+    const LaneMask stepping = workspace.active && !inner_done;
+    if (!stepping.any())
+      continue;
+    const LaneMask inertia_ok = computeStep(workspace, stepping);
+    const LaneMask ls_mask = stepping && inertia_ok;
+    linesearch(workspace, ls_mask);
+
+    LaneMask exhausted = LaneMask::Constant(false);
+    for (int l = 0; l < Lanes; l++) {
+      if (!stepping(l))
+        continue;
+      Lane &lane = *workspace.lanes[std::size_t(l)];
+      Results &results = *lane.results;
+      if (!inertia_ok(l)) {
+        results.converged = ConvergenceFlag::FAILED;
+        workspace.active(l) = false;
+        continue;
+      }
+      tryStep(workspace, l, workspace.alpha(l));
+      results.x_opt.swap(lane.ws.x_trial);
+      results.data_lams_opt = lane.ws.data_lams_trial;
+      results.merit = workspace.merit_trial(l);
+      results.num_iters++;
+      if (results.num_iters >= max_iters) {
+        results.converged = ConvergenceFlag::MAX_ITERS_REACHED;
+        exhausted(l) = true;
+      }
+    }
+    // as in ProxNLPSolverTpl, the last inner iteration is followed by an outer
+    // update
+    updateOuter(workspace, exhausted);
+    workspace.active = workspace.active && !exhausted;
+  }
+}
+
+template <typename Scalar, int Lanes>
+void BatchedSolverTpl<Scalar, Lanes>::evaluateLane(Workspace &workspace,
+                                                   const int l) const {
+  Lane &lane = *workspace.lanes[std::size_t(l)];
+  const Problem &prob = *lane.problem;
+  auto &ws = lane.ws;
+  Results &results = *lane.results;
+  const std::size_t num_c = prob.getNumConstraints();
+
+  prob.computeValuesAndDerivatives(results.x_opt, ws);
+  computeLaneMultipliers(workspace, l, results.data_lams_opt);
+  ws.data_lams_plus_reproj = ws.data_lams_plus;
+  ws.data_jac_proj_scale.setOnes();
+  for (std::size_t i = 0; i < num_c; i++) {
+    const ConstraintSet &cstr_set = *prob.getConstraint(i).set_;
+    cstr_set.applyProjectionJacobian(ws.shift_cstr_values[i],
+                                     ws.lams_plus_reproj[i]);
+    cstr_set.applyNormalConeProjectionJacobian(ws.shift_cstr_values[i],
+                                               ws.cstr_jac_proj_scale[i]);
+  }
+  prob.computeHessians(results.x_opt, ws, hess_approx == HessianApprox::EXACT);
+  lane.hessian = ws.objective_hessian + ws.cstr_lagrangian_hessian;
+
+  results.value = ws.objective_value;
+  results.merit = lane.merit.evaluate(results.x_opt, results.lams_opt, ws);
+  ws.prox_grad.setZero();
+  if (workspace.rho(l) > 0.) {
+    results.merit += lane.prox_penalty.call(results.x_opt);
+    lane.prox_penalty.computeGradient(results.x_opt, ws.prox_grad);
+    lane.prox_penalty.computeHessian(results.x_opt, ws.prox_hess);
+    lane.hessian += ws.prox_hess;
+  }
+
+  // primal residuals
+  ws.data_shift_cstr_values =
+      ws.data_cstr_values + workspace.mu(l) * results.data_lams_opt;
+  for (std::size_t i = 0; i < num_c; i++) {
+    const ConstraintSet &cstr_set = *prob.getConstraint(i).set_;
+    auto displ_cstr = ws.shift_cstr_values[i];
+    cstr_set.projection(displ_cstr, displ_cstr);
+    results.constraint_violations(long(i)) =
+        math::infty_norm(ws.cstr_values[i] - displ_cstr);
+  }
+  results.prim_infeas = math::infty_norm(results.constraint_violations);
+  PROXSUITE_NLP_RAISE_IF_NAN_NAME(results.merit, "merit");
+  PROXSUITE_NLP_RAISE_IF_NAN_NAME(ws.objective_gradient, "objective_gradient");
+
+  internal::setLane(workspace.gradient, l, ws.objective_gradient);
+  internal::setLane(workspace.prox_gradient, l, ws.prox_grad);
+  internal::setLane(workspace.hessian, l, lane.hessian);
+  internal::setLane(workspace.jacobian, l, ws.data_jacobians);
+  internal::setLane(workspace.lams, l, results.data_lams_opt);
+  internal::setLane(workspace.lams_plus, l, ws.data_lams_plus);
+  internal::setLane(workspace.lams_plus_reproj, l, ws.data_lams_plus_reproj);
+  internal::setLane(workspace.lams_pdal, l, ws.data_lams_pdal);
+  internal::setLane(workspace.jac_scale, l, ws.data_jac_proj_scale);
+  workspace.merit(l) = results.merit;
+  workspace.prim_infeas(l) = results.prim_infeas;
+}
+
+template <typename Scalar, int Lanes>
+void BatchedSolverTpl<Scalar, Lanes>::computeLaneMultipliers(
+    Workspace &workspace, const int l,
+    const ConstVectorRef &inner_lams_data) const {
+  Lane &lane = *workspace.lanes[std::size_t(l)];
+  const Problem &prob = *lane.problem;
+  auto &ws = lane.ws;
+  const Scalar mu = workspace.mu(l);
+  const Scalar mu_inv = workspace.mu_inv(l);
+  PROXSUITE_NLP_NOMALLOC_BEGIN;
+  ws.data_shift_cstr_values = ws.data_cstr_values + mu * ws.data_lams_prev;
+  for (std::size_t i = 0; i < prob.getNumConstraints(); i++) {
+    const ConstraintSet &cstr_set = *prob.getConstraint(i).set_;
+    cstr_set.normalConeProjection(ws.shift_cstr_values[i], ws.lams_plus[i]);
+  }
+  ws.data_lams_plus = mu_inv * ws.data_lams_plus;
+  ws.data_shift_cstr_pdal =
+      ws.data_shift_cstr_values - 0.5 * mu * inner_lams_data;
+  for (std::size_t i = 0; i < prob.getNumConstraints(); i++) {
+    const ConstraintSet &cstr_set = *prob.getConstraint(i).set_;
+    cstr_set.normalConeProjection(ws.shift_cstr_pdal[i], ws.lams_pdal[i]);
+  }
+  ws.data_lams_pdal *= mu_inv / pdal_beta_;
+  PROXSUITE_NLP_NOMALLOC_END;
+}
+
+template <typename Scalar, int Lanes>
+void BatchedSolverTpl<Scalar, Lanes>::tryStep(Workspace &workspace,
+                                              const int l,
+                                              const Scalar alpha) const {
+  Lane &lane = *workspace.lanes[std::size_t(l)];
+  auto &ws = lane.ws;
+  const Results &results = *lane.results;
+  PROXSUITE_NLP_NOMALLOC_BEGIN;
+  ws.tmp_dx_scaled = alpha * ws.prim_step;
+  lane.problem->manifold_->integrate(results.x_opt, ws.tmp_dx_scaled,
+                                     ws.x_trial);
+  ws.data_lams_trial = results.data_lams_opt + alpha * ws.dual_step;
+  PROXSUITE_NLP_NOMALLOC_END;
+}
+
+template <typename Scalar, int Lanes>
+Scalar BatchedSolverTpl<Scalar, Lanes>::evaluateTrialMerit(
+    Workspace &workspace, const int l, const Scalar alpha) const {
+  Lane &lane = *workspace.lanes[std::size_t(l)];
+  auto &ws = lane.ws;
+  tryStep(workspace, l, alpha);
+  PROXSUITE_NLP_NOMALLOC_BEGIN;
+  lane.problem->evaluate(ws.x_trial, ws);
+  PROXSUITE_NLP_NOMALLOC_END;
+  computeLaneMultipliers(workspace, l, ws.data_lams_trial);
+  return lane.merit.evaluate(ws.x_trial, ws.lams_trial, ws) +
+         lane.prox_penalty.call(ws.x_trial);
+}
+
+template <typename Scalar, int Lanes>
+void BatchedSolverTpl<Scalar, Lanes>::computeResiduals(
+    Workspace &workspace) const {
+  PROXSUITE_NLP_NOMALLOC_BEGIN;
+  workspace.dual_residual = workspace.gradient;
+  internal::addJacobianTransposeProduct(workspace.jacobian, workspace.lams,
+                                        workspace.dual_residual);
+  workspace.rhs_prim = workspace.dual_residual + workspace.prox_gradient;
+  workspace.rhs_dual =
+      (workspace.lams_plus - workspace.lams).colwise() * workspace.mu;
+  workspace.dual_infeas = internal::laneInftyNorm(workspace.dual_residual);
+  workspace.inner_crit = internal::laneInftyNorm(workspace.rhs_prim)
+                             .max(internal::laneInftyNorm(workspace.rhs_dual));
+  PROXSUITE_NLP_NOMALLOC_END;
+}
+
+template <typename Scalar, int Lanes>
+void BatchedSolverTpl<Scalar, Lanes>::updateOuter(Workspace &workspace,
+                                                  const LaneMask &mask) const {
+  if (!mask.any())
+    return;
+  const LaneMask success = mask && (workspace.prim_infeas < workspace.prim_tol);
+  const LaneMask failure = mask && !success;
+  for (int l = 0; l < Lanes; l++) {
+    if (!mask(l))
+      continue;
+    Lane &lane = *workspace.lanes[std::size_t(l)];
+    lane.ws.x_prev = lane.results->x_opt;
+    lane.prox_penalty.updateTarget(lane.ws.x_prev);
+    if (success(l))
+      lane.ws.data_lams_prev = lane.results->data_lams_opt;
+  }
+
+  const LaneArray new_mu =
+      (workspace.mu == mu_lower_)
+          .select(LaneArray::Constant(mu_init_),
+                  (workspace.mu * bcl_params.mu_update_factor).max(mu_lower_));
+  setPenalty(workspace, failure, new_mu);
+  const LaneArray mu_ratio = workspace.mu / mu_upper_;
+  workspace.prim_tol = failure.select(
+      prim_tol0 * workspace.mu.pow(bcl_params.prim_alpha),
+      success.select(workspace.prim_tol * mu_ratio.pow(bcl_params.prim_beta),
+                     workspace.prim_tol));
+  workspace.inner_tol = failure.select(
+      inner_tol0 * workspace.mu.pow(bcl_params.dual_alpha),
+      success.select(workspace.inner_tol * mu_ratio.pow(bcl_params.dual_beta),
+                     workspace.inner_tol));
+  workspace.inner_tol =
+      mask.select(workspace.inner_tol.max(inner_tol_min), workspace.inner_tol);
+  workspace.prim_tol =
+      mask.select(workspace.prim_tol.max(target_tol), workspace.prim_tol);
+
+  const LaneMask converged =
+      mask &&
+      (workspace.prim_infeas.max(workspace.dual_infeas) < target_tol);
+  setProxParameter(workspace, mask && !converged,
+                   workspace.rho * bcl_params.rho_update_factor);
+  for (int l = 0; l < Lanes; l++) {
+    if (!mask(l))
+      continue;
+    Results &results = *workspace.lanes[std::size_t(l)]->results;
+    if (converged(l)) {
+      results.converged = ConvergenceFlag::SUCCESS;
+      workspace.active(l) = false;
+    } else if (++results.al_iters >= max_al_iters) {
+      workspace.active(l) = false;
+    }
+  }
+}
+
+template <typename Scalar, int Lanes>
+auto BatchedSolverTpl<Scalar, Lanes>::computeStep(Workspace &workspace,
+                                                  const LaneMask &mask) const
+    -> LaneMask {
+  const long ndx = workspace.ndx;
+  const long ndual = workspace.numdual;
+  const LaneMatrix &jac = workspace.jacobian;
+  const LaneMatrix &scale = workspace.jac_scale;
+  PROXSUITE_NLP_NOMALLOC_BEGIN;
+  // correct the rhs for the symmetric system
+  workspace.tmp_dual = workspace.lams_plus_reproj - workspace.lams +
+                       scale * workspace.lams;
+  internal::addJacobianTransposeProduct(jac, workspace.tmp_dual,
+                                        workspace.rhs_prim);
+
+  // lower triangular part of the condensed KKT matrix
+  workspace.tmp_dual = scale.square().colwise() * workspace.mu_inv;
+  for (long j = 0; j < ndx; j++) {
+    for (long i = j; i < ndx; i++) {
+      auto kij = workspace.kkt_condensed.col(i + j * ndx);
+      kij = workspace.hessian.col(i + j * ndx);
+      for (long k = 0; k < ndual; k++)
+        kij += workspace.tmp_dual.col(k) * jac.col(k + i * ndual) *
+               jac.col(k + j * ndual);
+    }
+  }
+
+  // choose the regularization of each lane
+  workspace.delta.setConstant(DELTA_INIT);
+  LaneMask pending = mask;
+  LaneMask inertia_ok = LaneMask::Constant(false);
+  while (pending.any()) {
+    const LaneMask fact_ok = pending && factorizeCondensed(workspace);
+    workspace.delta_last =
+        fact_ok.select(workspace.delta, workspace.delta_last);
+    inertia_ok = inertia_ok || fact_ok;
+    pending = pending && !fact_ok;
+    const LaneMask last_zero = workspace.delta_last == Scalar(0.);
+    const LaneArray delta_from_zero = last_zero.select(
+        LaneArray::Constant(DELTA_NONZERO_INIT),
+        (del_dec_k * workspace.delta_last).max(DELTA_MIN));
+    const LaneArray delta_inc = last_zero.select(
+        workspace.delta * del_inc_big, workspace.delta * del_inc_k);
+    workspace.delta = pending.select(
+        (workspace.delta == Scalar(0.)).select(delta_from_zero, delta_inc),
+        workspace.delta);
+    pending = pending && (workspace.delta <= DELTA_MAX);
+  }
+
+  // eliminate the dual step:
+  // dl = (J dx + r_l) / mu, (H + J^T J / mu) dx = -(r_x + J^T r_l / mu)
+  LaneMatrix &dx = workspace.prim_step;
+  const LaneMatrix &llt = workspace.llt_factor;
+  workspace.tmp_dual =
+      (scale * workspace.rhs_dual).colwise() * workspace.mu_inv;
+  dx = workspace.rhs_prim;
+  internal::addJacobianTransposeProduct(jac, workspace.tmp_dual, dx);
+  dx = -dx;
+  for (long j = 0; j < ndx; j++) {
+    for (long k = 0; k < j; k++)
+      dx.col(j) -= llt.col(j + k * ndx) * dx.col(k);
+    dx.col(j) /= llt.col(j + j * ndx);
+  }
+  for (long j = ndx - 1; j >= 0; j--) {
+    for (long k = j + 1; k < ndx; k++)
+      dx.col(j) -= llt.col(k + j * ndx) * dx.col(k);
+    dx.col(j) /= llt.col(j + j * ndx);
+  }
+  workspace.tmp_dual.setZero();
+  internal::addJacobianProduct(jac, dx, workspace.tmp_dual);
+  workspace.dual_step =
+      (workspace.rhs_dual + scale * workspace.tmp_dual).colwise() *
+      workspace.mu_inv;
+
+  // directional derivative of the merit function
+  workspace.tmp_prim = workspace.gradient + workspace.prox_gradient;
+  internal::addJacobianTransposeProduct(jac, workspace.lams_pdal,
+                                        workspace.tmp_prim);
+  workspace.dmerit_dir = internal::laneDot(workspace.tmp_prim, dx);
+  workspace.tmp_dual = (workspace.lams - workspace.lams_pdal).colwise() *
+                       (pdal_beta_ * workspace.mu);
+  workspace.dmerit_dir +=
+      internal::laneDot(workspace.tmp_dual, workspace.dual_step);
+  PROXSUITE_NLP_NOMALLOC_END;
+  return inertia_ok;
+}
+
+template <typename Scalar, int Lanes>
+auto BatchedSolverTpl<Scalar, Lanes>::factorizeCondensed(
+    Workspace &workspace) const -> LaneMask {
+  const long ndx = workspace.ndx;
+  LaneMatrix &llt = workspace.llt_factor;
+  PROXSUITE_NLP_NOMALLOC_BEGIN;
+  llt = workspace.kkt_condensed;
+  LaneMask success = LaneMask::Constant(true);
+  for (long j = 0; j < ndx; j++) {
+    auto ljj = llt.col(j + j * ndx);
+    ljj += workspace.delta;
+    for (long k = 0; k < j; k++)
+      ljj -= llt.col(j + k * ndx).square();
+    // the KKT matrix has the correct inertia iff its Schur complement w.r.t.
+    // the negative-definite dual block is positive definite
+    success = success && (ljj > Scalar(0.));
+    ljj = ljj.sqrt();
+    for (long i = j + 1; i < ndx; i++) {
+      auto lij = llt.col(i + j * ndx);
+      for (long k = 0; k < j; k++)
+        lij -= llt.col(i + k * ndx) * llt.col(j + k * ndx);
+      lij /= ljj;
+    }
+  }
+  PROXSUITE_NLP_NOMALLOC_END;
+  return success;
+}
+
+template <typename Scalar, int Lanes>
+void BatchedSolverTpl<Scalar, Lanes>::linesearch(Workspace &workspace,
+                                                 const LaneMask &mask) const {
+  const LinesearchOptions &opts = ls_options;
+  const Scalar inf = std::numeric_limits<Scalar>::infinity();
+  LaneArray &alpha = workspace.alpha;
+  LaneArray &phi = workspace.merit_trial;
+  const LaneArray &phi0 = workspace.merit;
+  const LaneArray &dphi0 = workspace.dmerit_dir;
+
+  // try the full step; if an evaluation fails, aggressively backtrack until
+  // none does
+  for (int l = 0; l < Lanes; l++) {
+    if (!mask(l))
+      continue;
+    Lane &lane = *workspace.lanes[std::size_t(l)];
+    internal::getLane(workspace.prim_step, l, lane.ws.prim_step);
+    internal::getLane(workspace.dual_step, l, lane.ws.dual_step);
+    alpha(l) = 1.;
+    while (true) {
+      try {
+        phi(l) = evaluateTrialMerit(workspace, l, alpha(l));
+        break;
+      } catch (const std::runtime_error &) {
+        alpha(l) *= 0.5;
+        if (alpha(l) <= opts.alpha_min) {
+          alpha(l) = opts.alpha_min;
+          phi(l) = inf;
+          break;
+        }
+      }
+    }
+  }
+
+  LaneMask searching = mask && (dphi0.abs() >= opts.dphi_thresh);
+  LaneArray alpha_prev = LaneArray::Zero();
+  for (std::size_t i = 0; i < opts.max_num_steps; i++) {
+    searching = searching && !(phi - phi0 <= opts.armijo_c1 * alpha * dphi0);
+    if (!searching.any())
+      break;
+
+    // next step size
+    LaneArray alpha_next;
+    if (opts.interp_type == LSInterpolation::BISECTION) {
+      alpha_next = 0.5 * alpha;
+    } else {
+      // minimizer of the quadratic interpolant, safeguarded to
+      // [cmin * alpha, cmax * alpha]
+      const LaneArray amin = opts.contraction_min * alpha;
+      const LaneArray amax = opts.contraction_max * alpha;
+      const LaneArray a = (phi - phi0 - alpha * dphi0) / alpha.square();
+      const LaneArray pleft = (a * amin + dphi0) * amin + phi0;
+      const LaneArray pright = (a * amax + dphi0) * amax + phi0;
+      alpha_next = -dphi0 / (2. * a);
+      alpha_next = ((alpha_next > amax) || (alpha_next < amin))
+                       .select((pleft < pright).select(amin, amax), alpha_next);
+    }
+    alpha_next = alpha_next.isNaN().select(opts.contraction_min * alpha_prev,
+                                           alpha_next.max(opts.alpha_min));
+    alpha_prev = searching.select(alpha, alpha_prev);
+    alpha = searching.select(alpha_next, alpha);
+
+    LaneMask failed = LaneMask::Constant(false);
+    for (int l = 0; l < Lanes; l++) {
+      if (!searching(l))
+        continue;
+      try {
+        phi(l) = evaluateTrialMerit(workspace, l, alpha(l));
+      } catch (const std::runtime_error &) {
+        // keep the latest value, as ArmijoLinesearch
+        failed(l) = true;
+      }
+    }
+    searching = searching && (failed || (alpha > opts.alpha_min));
+  }
+  alpha = mask.select(alpha.max(opts.alpha_min), alpha);
+}
+
+template <typename Scalar, int Lanes>
+void BatchedSolverTpl<Scalar, Lanes>::setPenalty(
+    Workspace &workspace, const LaneMask &mask, const LaneArray &new_mu) const {
+  workspace.mu = mask.select(new_mu, workspace.mu);
+  workspace.mu_inv = workspace.mu.inverse();
+  for (int l = 0; l < Lanes; l++) {
+    if (!mask(l))
+      continue;
+    const Problem &prob = *workspace.lanes[std::size_t(l)]->problem;
+    for (std::size_t i = 0; i < prob.getNumConstraints(); i++)
+      prob.getConstraint(i).set_->setProxParameter(workspace.mu(l));
+  }
+}
+
+template <typename Scalar, int Lanes>
+void BatchedSolverTpl<Scalar, Lanes>::setProxParameter(
+    Workspace &workspace, const LaneMask &mask,
+    const LaneArray &new_rho) const {
+  workspace.rho = mask.select(new_rho, workspace.rho);
+  for (int l = 0; l < Lanes; l++) {
+    if (!mask(l))
+      continue;
+    auto &weights = workspace.lanes[std::size_t(l)]->prox_penalty.weights_;
+    weights.setZero();
+    weights.diagonal().setConstant(workspace.rho(l));
+  }
+}
+
+} // namespace nlp
+} // namespace proxsuite
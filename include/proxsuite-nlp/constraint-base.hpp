@@ -78,6 +78,13 @@ public:
 
   virtual ~ConstraintSetBase<Scalar>() = default;
 
+  /// @brief Copy of the constraint set, with its own proximal parameter. This
+  /// is required by ProxNLPSolverTpl::solveBatch().
+  virtual shared_ptr<Self> clone() const {
+    PROXSUITE_NLP_RUNTIME_ERROR("This constraint set does not implement "
+                                "clone().");
+  }
+
   bool operator==(const ConstraintSetBase<Scalar> &rhs) { return this == &rhs; }
 
   ///
@@ -102,8 +109,12 @@ public:
   /// @copydetails evaluateMoreauEnvelope
   Scalar computeMoreauEnvelope(const ConstVectorRef &zin,
                                VectorRef zprojout) const {
-    normalConeProjection(zin, zprojout);
-    return evaluateMoreauEnvelope(zin, zprojout);
+    // use the output as a buffer for the prox, avoiding a temporary
+    projection(zin, zprojout);
+    Scalar res = evaluate(zprojout);
+    zprojout = zin - zprojout;
+    res += static_cast<Scalar>(0.5) * mu_inv_ * zprojout.squaredNorm();
+    return res;
   }
 
   Scalar mu() const { return mu_; }
@@ -32,6 +32,8 @@ public:
   using Scalar = _Scalar;
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
   using Base = C2FunctionTpl<Scalar>;
+  using BaseData = typename Base::BaseData;
+  using SparseMatrixXs = typename Base::SparseMatrixXs;
 
   CostFunctionBaseTpl(const int nx, const int ndx) : Base(nx, ndx, 1) {}
   explicit CostFunctionBaseTpl(const ManifoldAbstractTpl<Scalar> &manifold)
@@ -45,6 +47,30 @@ public:
                                VectorRef out) const = 0;
   virtual void computeHessian(const ConstVectorRef &x, MatrixRef out) const = 0;
 
+  /* Versions using the data of the cost (see createData()) */
+
+  virtual Scalar call(const ConstVectorRef &x, BaseData * /*data*/) const {
+    return call(x);
+  }
+  virtual void computeGradient(const ConstVectorRef &x, BaseData * /*data*/,
+                               VectorRef out) const {
+    computeGradient(x, out);
+  }
+  virtual void computeHessian(const ConstVectorRef &x, BaseData * /*data*/,
+                              MatrixRef out) const {
+    computeHessian(x, out);
+  }
+
+  /// @brief Hessian in sparse storage (see
+  /// C1FunctionTpl::computeSparseJacobian()). The default evaluates the dense
+  /// Hessian into a temporary and drops its zeros.
+  virtual void computeSparseHessian(const ConstVectorRef &x, BaseData *data,
+                                    SparseMatrixXs &out) const {
+    MatrixXs Hdense = MatrixXs::Zero(this->ndx(), this->ndx());
+    computeHessian(x, data, Hdense);
+    out = Hdense.sparseView();
+  }
+
   /* Allocated versions */
 
   VectorXs computeGradient(const ConstVectorRef &x) const {
@@ -61,16 +87,12 @@ public:
 
   /* Implement C2FunctionTpl interface. */
 
-  VectorXs operator()(const ConstVectorRef &x) const {
-    VectorXs out(1, 1);
-    out << call(x);
-    return out;
+  void evaluate(const ConstVectorRef &x, VectorRef out) const {
+    out(0) = call(x);
   }
 
   void computeJacobian(const ConstVectorRef &x, MatrixRef Jout) const {
-    Eigen::Matrix<Scalar, 1, -1> gT = Jout.template topRows<1>();
-    computeGradient(x, gT.transpose());
-    Jout.row(0) = gT;
+    gradientToJacobian(Jout, [&](VectorRef g) { computeGradient(x, g); });
   }
 
   void vectorHessianProduct(const ConstVectorRef &x, const ConstVectorRef &v,
@@ -79,6 +101,29 @@ public:
     Hout *= v(0);
   }
 
+  void evaluate(const ConstVectorRef &x, BaseData *data, VectorRef out) const {
+    out(0) = call(x, data);
+  }
+
+  void computeJacobian(const ConstVectorRef &x, BaseData *data,
+                       MatrixRef Jout) const {
+    gradientToJacobian(Jout,
+                       [&](VectorRef g) { computeGradient(x, data, g); });
+  }
+
+  void vectorHessianProduct(const ConstVectorRef &x, const ConstVectorRef &v,
+                            BaseData *data, MatrixRef Hout) const {
+    computeHessian(x, data, Hout);
+    Hout *= v(0);
+  }
+
+  void sparseVectorHessianProduct(const ConstVectorRef &x,
+                                  const ConstVectorRef &v, BaseData *data,
+                                  SparseMatrixXs &Hout) const {
+    computeSparseHessian(x, data, Hout);
+    Hout *= v(0);
+  }
+
   virtual ~CostFunctionBaseTpl() = default;
 
   friend std::ostream &operator<<(std::ostream &ostr,
@@ -87,6 +132,26 @@ public:
     ostr << name;
     return ostr;
   }
+
+private:
+  /// Evaluate the gradient with @p grad straight into the row of @p Jout if
+  /// it is contiguous, else through a stack buffer: the rows of the stacked
+  /// constraint Jacobians are strided.
+  template <typename Fn>
+  static void gradientToJacobian(MatrixRef Jout, Fn grad) {
+    const Eigen::Index n = Jout.cols();
+    if (Jout.outerStride() == 1) {
+      Eigen::Map<VectorXs> g(Jout.data(), n);
+      grad(g);
+      return;
+    }
+    // the Eigen macro expects to be expanded in its namespace
+    namespace internal = ::Eigen::internal;
+    ei_declare_aligned_stack_constructed_variable(Scalar, buffer, n, nullptr);
+    Eigen::Map<VectorXs> g(buffer, n);
+    grad(g);
+    Jout.row(0) = g.transpose();
+  }
 };
 
 template <typename _Scalar> struct func_to_cost : CostFunctionBaseTpl<_Scalar> {
@@ -94,6 +159,10 @@ template <typename _Scalar> struct func_to_cost : CostFunctionBaseTpl<_Scalar> {
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
   using Base = CostFunctionBaseTpl<Scalar>;
   using C2Function = C2FunctionTpl<Scalar>;
+  using BaseData = typename Base::BaseData;
+  using Base::call;
+  using Base::computeGradient;
+  using Base::computeHessian;
 
   /** @brief    Constructor.
    *  @details  This defines an implicit conversion from the C2FunctionTpl type.
@@ -112,6 +181,27 @@ template <typename _Scalar> struct func_to_cost : CostFunctionBaseTpl<_Scalar> {
     underlying().vectorHessianProduct(x, v, Hout);
   }
 
+  shared_ptr<BaseData> createData() const {
+    return underlying().createData();
+  }
+
+  Scalar call(const ConstVectorRef &x, BaseData *data) const {
+    Eigen::Matrix<Scalar, 1, 1> out;
+    underlying().evaluate(x, data, out);
+    return out(0);
+  }
+
+  void computeGradient(const ConstVectorRef &x, BaseData *data,
+                       VectorRef out) const {
+    underlying().computeJacobian(x, data, out.transpose());
+  }
+
+  void computeHessian(const ConstVectorRef &x, BaseData *data,
+                      MatrixRef Hout) const {
+    const Eigen::Matrix<Scalar, 1, 1> v = Eigen::Matrix<Scalar, 1, 1>::Ones();
+    underlying().vectorHessianProduct(x, v, data, Hout);
+  }
+
 private:
   shared_ptr<C2Function> underlying_;
   const C2Function &underlying() const { return *underlying_; }
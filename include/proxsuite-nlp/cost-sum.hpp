@@ -14,7 +14,25 @@ public:
   using Scalar = _Scalar;
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
   using Base = CostFunctionBaseTpl<Scalar>;
+  using BaseData = typename Base::BaseData;
   using BasePtr = shared_ptr<Base>;
+  using Base::call;
+  using Base::computeGradient;
+  using Base::computeHessian;
+
+  /// Data of the components, and buffers for their derivatives.
+  struct Data : BaseData {
+    std::vector<shared_ptr<BaseData>> component_data;
+    VectorXs grad;
+    MatrixXs hess;
+
+    explicit Data(const CostSumTpl &cost)
+        : grad(VectorXs::Zero(cost.ndx())),
+          hess(MatrixXs::Zero(cost.ndx(), cost.ndx())) {
+      for (const auto &comp : cost.components_)
+        component_data.push_back(comp->createData());
+    }
+  };
 
   std::vector<BasePtr> components_; /// component sub-costs
   std::vector<Scalar> weights_;     /// cost component weights
@@ -54,6 +72,48 @@ public:
     }
   }
 
+  /// @remark The data must be created after adding all the components.
+  shared_ptr<BaseData> createData() const {
+    return std::make_shared<Data>(*this);
+  }
+
+  Scalar call(const ConstVectorRef &x, BaseData *data) const {
+    if (data == nullptr)
+      return call(x);
+    Data &d = static_cast<Data &>(*data);
+    assert(d.component_data.size() == numComponents());
+    Scalar result_ = 0.;
+    for (std::size_t i = 0; i < numComponents(); i++) {
+      result_ +=
+          weights_[i] * components_[i]->call(x, d.component_data[i].get());
+    }
+    return result_;
+  }
+
+  void computeGradient(const ConstVectorRef &x, BaseData *data,
+                       VectorRef out) const {
+    if (data == nullptr)
+      return computeGradient(x, out);
+    Data &d = static_cast<Data &>(*data);
+    out.setZero();
+    for (std::size_t i = 0; i < numComponents(); i++) {
+      components_[i]->computeGradient(x, d.component_data[i].get(), d.grad);
+      out += weights_[i] * d.grad;
+    }
+  }
+
+  void computeHessian(const ConstVectorRef &x, BaseData *data,
+                      MatrixRef out) const {
+    if (data == nullptr)
+      return computeHessian(x, out);
+    Data &d = static_cast<Data &>(*data);
+    out.setZero();
+    for (std::size_t i = 0; i < numComponents(); i++) {
+      components_[i]->computeHessian(x, d.component_data[i].get(), d.hess);
+      out += weights_[i] * d.hess;
+    }
+  }
+
   /* CostSum API definition */
 
   void addComponent(shared_ptr<Base> comp, const Scalar w = 1.) {
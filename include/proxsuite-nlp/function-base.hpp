@@ -5,8 +5,24 @@
 
 #include "proxsuite-nlp/fwd.hpp"
 
+#include <Eigen/SparseCore>
+#include <vector>
+
 namespace proxsuite {
 namespace nlp {
+
+/**
+ * @brief Base struct for the data of a function.
+ * @details Functions which need intermediate buffers keep them in a data
+ * object, created by BaseFunctionTpl::createData(), rather than in the
+ * function itself. A function (the model) can then be evaluated concurrently,
+ * with one data object per thread.
+ */
+template <typename _Scalar> struct FunctionDataTpl {
+  using Scalar = _Scalar;
+  virtual ~FunctionDataTpl() = default;
+};
+
 /**
  * @brief Base function type.
  */
@@ -15,10 +31,12 @@ protected:
   int nx_;
   int ndx_;
   int nr_;
+  std::vector<std::size_t> component_deps_;
 
 public:
   using Scalar = _Scalar;
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
+  using BaseData = FunctionDataTpl<Scalar>;
 
   BaseFunctionTpl(const int nx, const int ndx, const int nr)
       : nx_(nx), ndx_(ndx), nr_(nr) {}
@@ -27,7 +45,29 @@ public:
       : BaseFunctionTpl(manifold.nx(), manifold.ndx(), nr) {}
 
   /// @brief      Evaluate the residual at a given point x.
-  virtual VectorXs operator()(const ConstVectorRef &x) const = 0;
+  virtual void evaluate(const ConstVectorRef &x, VectorRef out) const = 0;
+
+  /// @brief      Create the data of the function. Functions without
+  /// intermediate buffers return nullptr.
+  virtual shared_ptr<BaseData> createData() const { return nullptr; }
+
+  /// @copybrief evaluate()
+  /// @details    Uses the buffers of @p data, obtained from createData(). The
+  /// default ignores @p data and calls evaluate(x, out).
+  virtual void evaluate(const ConstVectorRef &x, BaseData * /*data*/,
+                        VectorRef out) const {
+    evaluate(x, out);
+  }
+
+  /** @copybrief evaluate()
+   *
+   * Allocated version of the evaluate() method.
+   */
+  VectorXs operator()(const ConstVectorRef &x) const {
+    VectorXs out(nr_);
+    evaluate(x, out);
+    return out;
+  }
 
   virtual ~BaseFunctionTpl() = default;
 
@@ -37,6 +77,20 @@ public:
   int ndx() const { return ndx_; }
   /// Get function codimension.
   int nr() const { return nr_; }
+
+  /// @brief Declare the components of a Cartesian product input space
+  /// (CartesianProductTpl) which the function depends on.
+  /// @details The Jacobian (and Hessian) blocks of the other components are
+  /// then assumed to be structurally zero. This is used to derive the block
+  /// structure of the KKT system for LDLTChoice::BLOCKSPARSE.
+  void setComponentDependencies(const std::vector<std::size_t> &deps) {
+    component_deps_ = deps;
+  }
+  /// Components of the input space the function depends on. Empty (the
+  /// default) means all of them.
+  const std::vector<std::size_t> &componentDependencies() const {
+    return component_deps_;
+  }
 };
 
 /** @brief  Differentiable function, with method for the Jacobian.
@@ -47,6 +101,8 @@ public:
   using Scalar = _Scalar;
   using Base = BaseFunctionTpl<_Scalar>;
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
+  using BaseData = typename Base::BaseData;
+  using SparseMatrixXs = Eigen::SparseMatrix<Scalar>;
 
   // We can't use using Base::Base because of MSVC explicit template
   // instantiation
@@ -68,6 +124,46 @@ public:
     computeJacobian(x, Jout);
     return Jout;
   }
+
+  /// @brief      Evaluate the function and its Jacobian at the same point.
+  /// @details    Override this to share intermediate results (e.g. forward
+  /// kinematics) between both. The default calls evaluate() then
+  /// computeJacobian(). Both are checked not to allocate (see
+  /// PROXSUITE_NLP_NOMALLOC_BEGIN).
+  virtual void computeValueAndJacobian(const ConstVectorRef &x, VectorRef out,
+                                       MatrixRef Jout) const {
+    this->evaluate(x, out);
+    computeJacobian(x, Jout);
+  }
+
+  /// @copybrief computeJacobian()
+  /// @details    Uses the buffers of @p data (see createData()).
+  virtual void computeJacobian(const ConstVectorRef &x, BaseData * /*data*/,
+                               MatrixRef Jout) const {
+    computeJacobian(x, Jout);
+  }
+
+  /// @copybrief computeValueAndJacobian()
+  /// @details    Uses the buffers of @p data (see createData()).
+  virtual void computeValueAndJacobian(const ConstVectorRef &x, BaseData *data,
+                                       VectorRef out, MatrixRef Jout) const {
+    if (data == nullptr)
+      return computeValueAndJacobian(x, out, Jout);
+    this->evaluate(x, data, out);
+    computeJacobian(x, data, Jout);
+  }
+
+  /// @brief      Jacobian matrix in sparse storage, for the sparse KKT path
+  /// of the solver (see ProxNLPSolverTpl::sparse_kkt_).
+  /// @details    Override this for functions with a sparse Jacobian. The
+  /// default evaluates the dense Jacobian into a temporary and drops its
+  /// zeros.
+  virtual void computeSparseJacobian(const ConstVectorRef &x, BaseData *data,
+                                     SparseMatrixXs &Jout) const {
+    MatrixXs Jdense = MatrixXs::Zero(this->nr(), this->ndx());
+    computeJacobian(x, data, Jdense);
+    Jout = Jdense.sparseView();
+  }
 };
 
 /** @brief  Twice-differentiable function, with method Jacobian and
@@ -79,6 +175,8 @@ public:
   using Scalar = _Scalar;
   using Base = C1FunctionTpl<_Scalar>;
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
+  using BaseData = typename Base::BaseData;
+  using SparseMatrixXs = typename Base::SparseMatrixXs;
 
   // We can't use using Base::Base because of MSVC explicit template
   // instantiation
@@ -93,6 +191,27 @@ public:
                                     MatrixRef Hout) const {
     Hout.setZero();
   }
+
+  /// @copybrief vectorHessianProduct()
+  /// @details    Uses the buffers of @p data (see createData()).
+  virtual void vectorHessianProduct(const ConstVectorRef &x,
+                                    const ConstVectorRef &v,
+                                    BaseData * /*data*/,
+                                    MatrixRef Hout) const {
+    vectorHessianProduct(x, v, Hout);
+  }
+
+  /// @copybrief vectorHessianProduct()
+  /// @details    Sparse storage version, see
+  /// C1FunctionTpl::computeSparseJacobian().
+  virtual void sparseVectorHessianProduct(const ConstVectorRef &x,
+                                          const ConstVectorRef &v,
+                                          BaseData *data,
+                                          SparseMatrixXs &Hout) const {
+    MatrixXs Hdense = MatrixXs::Zero(this->ndx(), this->ndx());
+    vectorHessianProduct(x, v, data, Hdense);
+    Hout = Hdense.sparseView();
+  }
 };
 
 } // namespace nlp
@@ -15,15 +15,34 @@ template <typename _Scalar> struct ComposeFunctionTpl : C2FunctionTpl<_Scalar> {
 public:
   using Scalar = _Scalar;
   using Base = C2FunctionTpl<Scalar>;
+  using BaseData = typename Base::BaseData;
   using Base::computeJacobian;
+  using Base::evaluate;
   using Base::vectorHessianProduct;
 
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
 
+  /// Buffers for the inner function value and the Jacobians of both
+  /// functions.
+  struct Data : BaseData {
+    VectorXs right_value;
+    MatrixXs Jleft;
+    MatrixXs Jright;
+    shared_ptr<BaseData> left_data;
+    shared_ptr<BaseData> right_data;
+
+    explicit Data(const ComposeFunctionTpl &func)
+        : right_value(VectorXs::Zero(func.right().nr())),
+          Jleft(MatrixXs::Zero(func.left().nr(), func.left().ndx())),
+          Jright(MatrixXs::Zero(func.right().nr(), func.right().ndx())),
+          left_data(func.left().createData()),
+          right_data(func.right().createData()) {}
+  };
+
   ComposeFunctionTpl(const shared_ptr<Base> &left,
                      const shared_ptr<Base> &right)
       : Base(right->nx(), right->ndx(), left->nr()), left_(left),
-        right_(right) {
+        right_(right), default_data_(*this) {
     if (left->nx() != right->nr()) {
       PROXSUITE_NLP_RUNTIME_ERROR(fmt::format(
           "Incompatible dimensions ({:d} and {:d}).", left->nx(), right->nr()));
@@ -31,13 +50,31 @@ public:
     assert(left->nx() == right->nr());
   }
 
-  VectorXs operator()(const ConstVectorRef &x) const {
-    return left()(right()(x));
+  shared_ptr<BaseData> createData() const {
+    return std::make_shared<Data>(*this);
+  }
+
+  void evaluate(const ConstVectorRef &x, VectorRef out) const {
+    evaluate(x, &default_data_, out);
   }
 
   void computeJacobian(const ConstVectorRef &x, MatrixRef Jout) const {
-    MatrixXs Jleft = left().computeJacobian(right()(x));
-    Jout.noalias() = Jleft * right().computeJacobian(x);
+    computeJacobian(x, &default_data_, Jout);
+  }
+
+  void evaluate(const ConstVectorRef &x, BaseData *data, VectorRef out) const {
+    Data &d = getData(data);
+    right().evaluate(x, d.right_data.get(), d.right_value);
+    left().evaluate(d.right_value, d.left_data.get(), out);
+  }
+
+  void computeJacobian(const ConstVectorRef &x, BaseData *data,
+                       MatrixRef Jout) const {
+    Data &d = getData(data);
+    right().computeValueAndJacobian(x, d.right_data.get(), d.right_value,
+                                    d.Jright);
+    left().computeJacobian(d.right_value, d.left_data.get(), d.Jleft);
+    Jout.noalias() = d.Jleft * d.Jright;
   }
 
   const Base &left() const { return *left_; }
@@ -46,6 +83,13 @@ public:
 private:
   shared_ptr<Base> left_;
   shared_ptr<Base> right_;
+  /// Data used by the evaluations without explicit data, which are therefore
+  /// not reentrant.
+  mutable Data default_data_;
+
+  Data &getData(BaseData *data) const {
+    return data ? static_cast<Data &>(*data) : default_data_;
+  }
 };
 
 /// @brief    Compose two function objects.
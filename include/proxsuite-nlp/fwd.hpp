@@ -53,6 +53,9 @@ template <typename Scalar> struct BCLParamsTpl;
 
 /* Function types */
 
+// fwd FunctionDataTpl
+template <typename Scalar> struct FunctionDataTpl;
+
 // fwd BaseFunction
 template <typename Scalar> struct BaseFunctionTpl;
 
@@ -109,5 +112,7 @@ enum VerboseLevel { QUIET = 0, VERBOSE = 1, VERYVERBOSE = 2 };
 
 template <typename Scalar> class ProxNLPSolverTpl;
 
+template <typename Scalar, int Lanes> class BatchedSolverTpl;
+
 } // namespace nlp
 } // namespace proxsuite
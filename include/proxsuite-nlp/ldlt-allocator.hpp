@@ -6,6 +6,8 @@
 
 #include "proxsuite-nlp/linalg/block-ldlt.hpp"
 #include "proxsuite-nlp/linalg/bunchkaufman.hpp"
+#include "proxsuite-nlp/linalg/sparse-ldlt.hpp"
+#include "proxsuite-nlp/linalg/block-tridiag.hpp"
 #ifdef PROXSUITE_NLP_USE_PROXSUITE_LDLT
 #include "proxsuite-nlp/linalg/proxsuite-ldlt-wrap.hpp"
 #endif
@@ -29,14 +31,25 @@ enum class LDLTChoice {
   /// Use Eigen's implementation.
   EIGEN,
   /// Use Proxsuite's LDLT.
-  PROXSUITE
+  PROXSUITE,
+  /// Use a sparse LDLT with fill-reducing ordering (Eigen's SimplicialLDLT,
+  /// see linalg::SparseLDLT). It does not pivot: the matrix should be
+  /// quasi-definite, as the KKT matrix is once the inertia correction has
+  /// regularized its primal block. A zero pivot met before then makes the
+  /// factorization fail, which the solver handles as a wrong inertia. The
+  /// KKT matrix is assembled directly in sparse form with
+  /// ProxNLPSolverTpl::sparse_kkt_.
+  SPARSE,
+  /// Use a stage-wise block-tridiagonal (Riccati-like) LDLT.
+  BLOCKTRIDIAG
 };
 
 template <typename Scalar,
           class MatrixType = typename math_types<Scalar>::MatrixXs>
 using LDLTVariant =
     boost::variant<linalg::DenseLDLT<Scalar>, linalg::BlockLDLT<Scalar>,
-                   Eigen::LDLT<MatrixType>, Eigen::BunchKaufman<MatrixType>
+                   Eigen::LDLT<MatrixType>, Eigen::BunchKaufman<MatrixType>,
+                   linalg::SparseLDLT<Scalar>, linalg::BlockTridiagLDLT<Scalar>
 #ifdef PROXSUITE_NLP_USE_PROXSUITE_LDLT
                    ,
                    linalg::ProxSuiteLDLTWrapper<Scalar>
@@ -98,6 +111,16 @@ inline isize get_total_dim_helper(const std::vector<isize> &nprims,
          std::accumulate(nduals.begin(), nduals.end(), 0);
 }
 
+/// Allocate a BlockLDLT for the given block @p structure, and search for a
+/// sparsifying permutation of its blocks.
+template <typename Scalar>
+linalg::BlockLDLT<Scalar>
+allocate_block_ldlt(isize size, const linalg::SymbolicBlockMatrix &structure) {
+  linalg::BlockLDLT<Scalar> block_ldlt(size, structure);
+  block_ldlt.findSparsifyingPermutation();
+  return block_ldlt;
+}
+
 template <typename Scalar>
 LDLTVariant<Scalar> allocate_ldlt_from_sizes(const std::vector<isize> &nprims,
                                              const std::vector<isize> &nduals,
@@ -110,15 +133,19 @@ LDLTVariant<Scalar> allocate_ldlt_from_sizes(const std::vector<isize> &nprims,
     return linalg::DenseLDLT<Scalar>(size);
   case LDLTChoice::BUNCHKAUFMAN:
     return Eigen::BunchKaufman<MatrixXs>(size);
-  case LDLTChoice::BLOCKSPARSE: {
-    auto structure = create_default_block_structure(nprims, nduals);
-
-    linalg::BlockLDLT<Scalar> block_ldlt(size, structure);
-    block_ldlt.findSparsifyingPermutation();
-    return block_ldlt;
-  }
+  case LDLTChoice::BLOCKSPARSE:
+    return allocate_block_ldlt<Scalar>(
+        size, create_default_block_structure(nprims, nduals));
   case LDLTChoice::EIGEN:
     return Eigen::LDLT<MatrixXs>(size);
+  case LDLTChoice::SPARSE:
+    return linalg::SparseLDLT<Scalar>(size);
+  case LDLTChoice::BLOCKTRIDIAG: {
+    // without the problem structure, all rows form a single stage
+    std::vector<isize> perm(std::size_t(size), 0);
+    std::iota(perm.begin(), perm.end(), isize(0));
+    return linalg::BlockTridiagLDLT<Scalar>(perm, {size});
+  }
   case LDLTChoice::PROXSUITE:
 #ifdef PROXSUITE_NLP_USE_PROXSUITE_LDLT
     return linalg::ProxSuiteLDLTWrapper<Scalar>(size, size);
@@ -193,6 +220,60 @@ struct ComputeSignatureVisitor {
   Eigen::VectorXi &signature;
 };
 
+/// Set the number of threads of the LDLT backends which support it
+/// (linalg::DenseLDLT and linalg::BlockLDLT).
+struct SetNumThreadsVisitor {
+  template <typename Fac> void operator()(Fac &) const {}
+
+  template <typename Scalar>
+  void operator()(linalg::DenseLDLT<Scalar> &facto) const {
+    facto.setNumThreads(num_threads);
+  }
+
+  template <typename Scalar>
+  void operator()(linalg::BlockLDLT<Scalar> &facto) const {
+    facto.setNumThreads(num_threads);
+  }
+  std::size_t num_threads;
+};
+
+/// Set the rows whose diagonal may be shifted after factorization, for the
+/// LDLT backends which support it (linalg::DenseLDLT and linalg::BlockLDLT).
+struct SetUpdatableRowsVisitor {
+  template <typename Fac> void operator()(Fac &) const {}
+
+  template <typename Scalar>
+  void operator()(linalg::DenseLDLT<Scalar> &facto) const {
+    facto.setUpdatableRows(start, size);
+  }
+
+  template <typename Scalar>
+  void operator()(linalg::BlockLDLT<Scalar> &facto) const {
+    facto.setUpdatableRows(start, size);
+  }
+  isize start;
+  isize size;
+};
+
+/// Shift the diagonal of the updatable rows of the factorized matrix.
+/// Returns false if the backend does not support it, in which case the matrix
+/// should be factorized again.
+template <typename Scalar>
+struct UpdateDiagonalVisitor : boost::static_visitor<bool> {
+  explicit UpdateDiagonalVisitor(Scalar shift) : shift(shift) {}
+
+  template <typename Fac> bool operator()(Fac &) const { return false; }
+
+  bool operator()(linalg::DenseLDLT<Scalar> &facto) const {
+    return facto.updateDiagonal(shift);
+  }
+
+  bool operator()(linalg::BlockLDLT<Scalar> &facto) const {
+    return facto.updateDiagonal(shift);
+  }
+  Scalar shift;
+};
+
 inline std::array<int, 3>
 computeInertiaTuple(const Eigen::Ref<Eigen::VectorXi const> &signature) {
   using Eigen::Index;
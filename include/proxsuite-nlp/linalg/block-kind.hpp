@@ -41,6 +41,22 @@ PROXSUITE_NLP_DLLAPI BlockKind add(BlockKind a, BlockKind b) noexcept;
 /// BlockKind of the product of two matrices.
 PROXSUITE_NLP_DLLAPI BlockKind mul(BlockKind a, BlockKind b) noexcept;
 
+/// Strategy used to search for a fill-reducing permutation of the blocks of a
+/// SymbolicBlockMatrix.
+enum class BlockOrdering {
+  /// Exact search for small matrices, greedy ordering otherwise.
+  AUTO,
+  /// Exhaustive search over all permutations. The cost is factorial in the
+  /// number of blocks.
+  BRUTE_FORCE,
+  /// Greedy minimum-fill ordering of the block graph.
+  GREEDY,
+};
+
+/// Largest number of blocks for which BlockOrdering::AUTO uses the
+/// brute-force search.
+constexpr isize BLOCK_ORDERING_BRUTE_FORCE_MAX = 6;
+
 /// @brief    Symbolic representation of the sparsity structure of a (square)
 /// block matrix.
 /// @details  This struct describes the block-wise layout of a matrix, in
@@ -114,6 +130,18 @@ public:
   Eigen::ComputationInfo
   brute_force_best_permutation(SymbolicBlockMatrix const &in, isize *best_perm,
                                isize *iwork);
+  /// Greedy fill-reducing ordering of the blocks. At each step, this
+  /// eliminates the block whose elimination creates the fewest new nonzeros
+  /// (ties broken by weighted degree, then by index), in the manner of the
+  /// minimum degree algorithm. The result is never worse than the identity
+  /// ordering.
+  /// The struct instance *this will hold the symbolic factorization of the
+  /// resulting permutation.
+  /// @param in    the input matrix to analyze.
+  /// @param iwork workspace; has length `in.nsegments()`.
+  Eigen::ComputationInfo
+  greedy_fill_reducing_permutation(SymbolicBlockMatrix const &in,
+                                   isize *best_perm, isize *iwork);
   bool check_if_symmetric() const noexcept;
   isize count_nnz() const noexcept;
   /// Perform symbolic block-wise LLT decomposition;
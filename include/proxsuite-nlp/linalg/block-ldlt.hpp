@@ -7,6 +7,7 @@
 
 #include "proxsuite-nlp/linalg/dense.hpp"
 #include "proxsuite-nlp/linalg/block-triangular.hpp"
+#include "proxsuite-nlp/linalg/symbolic-cache.hpp"
 
 #include "proxsuite-nlp/linalg/gemmt.hpp"
 
@@ -23,15 +24,20 @@ template <typename Scalar> struct block_impl {
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
   MatrixRef mat;
   SymbolicBlockMatrix sym_structure;
+  /// Number of threads for the trailing updates.
+  std::size_t nthreads = 1;
+  /// @param nsteps  Number of block rows to eliminate (all by default). The
+  /// trailing block is left holding its Schur complement.
   /// @returns bool whether the decomposition was successful.
-  bool ldlt_in_place_impl(SignMatrix &sign) {
+  bool ldlt_in_place_impl(SignMatrix &sign,
+                          isize nsteps = std::numeric_limits<isize>::max()) {
     if (!sym_structure.performed_llt) {
       assert(false && "Block structure was not analyzed yet.");
       return false;
     }
     const isize nblocks = sym_structure.nsegments();
     const isize n = mat.rows();
-    if ((nblocks == 0) || (n <= 1)) {
+    if ((nblocks == 0) || (n <= 1) || (nsteps == 0)) {
       return true;
     }
 
@@ -53,7 +59,7 @@ template <typename Scalar> struct block_impl {
 
     case TriL: {
       // compute l00
-      backend::dense_ldlt_in_place(l00, sign);
+      backend::dense_ldlt_in_place(l00, sign, nthreads);
 
       isize offset = bs;
 
@@ -137,8 +143,12 @@ template <typename Scalar> struct block_impl {
     }
     }
 
-    isize offset_i = bs;
-    for (isize i = 1; i < nblocks; ++i) {
+    // the updates of the column blocks are independent
+    auto update_column_block = [&](isize i0) {
+      const isize i = i0 + 1;
+      isize offset_i = bs;
+      for (isize k = 1; k < i; ++k)
+        offset_i += sym_structure.segment_lens[k];
       const isize bsi = sym_structure.segment_lens[i];
       Eigen::Block<MatrixRef> li0 = mat.block(offset_i, 0, bsi, bs);
       Eigen::Block<decltype(work)> li0_prev =
@@ -167,15 +177,15 @@ template <typename Scalar> struct block_impl {
 
         offset_j += bsj;
       }
-
-      offset_i += bsi;
-    }
+    };
+    omp::parallel_for(nthreads, nblocks - 1, update_column_block);
 
     return block_impl{
         l11,
         sym_structure.submatrix(1, nblocks - 1),
+        nthreads,
     }
-        .ldlt_in_place_impl(sign);
+        .ldlt_in_place_impl(sign, nsteps - 1);
   }
 };
 
@@ -184,9 +194,10 @@ template <typename Scalar> struct block_impl {
 /// @brief Block sparsity-aware LDLT factorization algorithm.
 /// @details  This struct owns the data of the SymbolicBlockMatrix given as
 /// input.
-/// The member function findSparsifyingPermutation() uses a heuristic
-/// (for now a brute-force search) to find a sparsity-maximizing permutation of
-/// the blocks in the input matrix.
+/// The member function findSparsifyingPermutation() searches for a
+/// sparsity-maximizing permutation of the blocks in the input matrix, either
+/// exhaustively (for a handful of blocks) or with a greedy fill-reducing
+/// ordering.
 /// updateBlockPermutationMatrix() updates the permutation matrix according to
 /// the stored block-wise permutation indices.
 ///
@@ -218,6 +229,22 @@ protected:
   std::vector<isize> m_perm_inv;
   std::vector<isize> m_iwork;
   std::vector<isize> m_start_idx;
+  mutable VectorXs m_perm_buf;
+  std::size_t m_num_threads = 1;
+  /// First updatable row and number of updatable rows, in the input ordering.
+  isize m_update_start = 0;
+  isize m_update_size = 0;
+  /// Number of leading blocks eliminated before the updatable rows.
+  isize m_update_block = 0;
+  /// Schur complement of the trailing blocks, before their factorization.
+  MatrixXs m_schur;
+  bool m_has_schur = false;
+  SignMatrix m_lead_sign = SignMatrix::ZeroSign;
+
+  /// Compute the number of leading blocks which do not contain updatable
+  /// rows, in the permuted ordering.
+  isize computeUpdateBlock() const;
+  void factorizeTrailing();
 
   BlockLDLT &updateBlockPermutationMatrix(SymbolicBlockMatrix const &in);
 
@@ -227,7 +254,7 @@ public:
   BlockLDLT(isize size, SymbolicBlockMatrix const &structure)
       : Base(), m_matrix(size, size), m_structure(structure.copy()),
         m_permutation(size), m_perm(nblocks()), m_perm_inv(nblocks()),
-        m_iwork(nblocks()), m_start_idx(nblocks()) {
+        m_iwork(nblocks()), m_start_idx(nblocks()), m_perm_buf(size) {
     std::iota(m_perm.begin(), m_perm.end(), isize(0));
     m_permutation.setIdentity();
     m_struct_tr = m_structure.transpose();
@@ -242,6 +269,13 @@ public:
     m_perm_inv = other.m_perm_inv;
     m_iwork = other.m_iwork;
     m_start_idx = other.m_start_idx;
+    m_num_threads = other.m_num_threads;
+    m_update_start = other.m_update_start;
+    m_update_size = other.m_update_size;
+    m_update_block = other.m_update_block;
+    m_schur = other.m_schur;
+    m_has_schur = other.m_has_schur;
+    m_lead_sign = other.m_lead_sign;
   }
 
   /// Compute indices indicating where blocks start
@@ -276,8 +310,12 @@ public:
   auto blockPermIndices() -> std::vector<isize> & { return m_perm; }
 
   /// @brief Find a sparsity-maximizing permutation of the blocks. This will
-  /// also compute the symbolic factorization.
-  BlockLDLT &findSparsifyingPermutation();
+  /// also compute the symbolic factorization. Permutations are looked up in,
+  /// and stored into, the SymbolicAnalysisCache.
+  /// @param method  Ordering strategy. By default, the exact brute-force
+  /// search is only used for small numbers of blocks.
+  BlockLDLT &
+  findSparsifyingPermutation(BlockOrdering method = BlockOrdering::AUTO);
 
   inline const PermutationType &permutationP() const { return m_permutation; }
 
@@ -301,10 +339,51 @@ public:
 
   const MatrixXs &matrixLDLT() const override { return m_matrix; }
 
+  /// Set the number of threads used by the numerical factorization.
+  void setNumThreads(std::size_t num_threads) { m_num_threads = num_threads; }
+  std::size_t getNumThreads() const { return m_num_threads; }
+
+  /// @brief Set the rows (of the input matrix) whose diagonal entries may be
+  /// shifted by updateDiagonal().
+  /// @details  compute() then keeps the Schur complement of the trailing
+  /// blocks, starting from the first block (in the permuted ordering) which
+  /// contains such rows.
+  void setUpdatableRows(isize start, isize size) {
+    m_update_start = start;
+    m_update_size = size;
+    m_has_schur = false;
+  }
+
+  /// @brief Add @p shift to the diagonal of the rows set by
+  /// setUpdatableRows(), by only refactorizing the trailing blocks.
+  /// @returns whether the update could be performed; otherwise, the matrix
+  /// should be factorized again with compute().
+  bool updateDiagonal(const Scalar shift);
+
   inline void compute() {
+    m_update_block = computeUpdateBlock();
+    if (m_update_block > 0 && m_update_block < isize(nblocks())) {
+      const isize rem =
+          m_matrix.rows() - std::accumulate(m_structure.segment_lens,
+                                            m_structure.segment_lens +
+                                                m_update_block,
+                                            isize(0));
+      m_sign = SignMatrix::ZeroSign;
+      bool flag =
+          backend::block_impl<Scalar>{m_matrix, m_structure, m_num_threads}
+              .ldlt_in_place_impl(m_sign, m_update_block);
+      m_lead_sign = m_sign;
+      m_schur = m_matrix.bottomRightCorner(rem, rem);
+      m_has_schur = flag;
+      factorizeTrailing();
+      if (!flag)
+        m_info = Eigen::NumericalIssue;
+      return;
+    }
+    m_has_schur = false;
     m_info =
-        backend::block_impl<Scalar>{m_matrix, m_structure}.ldlt_in_place_impl(
-            m_sign)
+        backend::block_impl<Scalar>{m_matrix, m_structure, m_num_threads}
+                .ldlt_in_place_impl(m_sign)
             ? Eigen::Success
             : Eigen::NumericalIssue;
   }
@@ -23,9 +23,28 @@ void BlockLDLT<Scalar>::setBlockPermutation(isize const *new_perm) {
 }
 
 template <typename Scalar>
-BlockLDLT<Scalar> &BlockLDLT<Scalar>::findSparsifyingPermutation() {
+BlockLDLT<Scalar> &
+BlockLDLT<Scalar>::findSparsifyingPermutation(BlockOrdering method) {
   SymbolicBlockMatrix in(m_structure.copy());
-  m_structure.brute_force_best_permutation(in, m_perm.data(), m_iwork.data());
+  if (method == BlockOrdering::AUTO) {
+    method = in.nsegments() <= BLOCK_ORDERING_BRUTE_FORCE_MAX
+                 ? BlockOrdering::BRUTE_FORCE
+                 : BlockOrdering::GREEDY;
+  }
+  auto &cache = SymbolicAnalysisCache::instance();
+  if (!cache.find(in, method, m_perm)) {
+    switch (method) {
+    case BlockOrdering::BRUTE_FORCE:
+      m_structure.brute_force_best_permutation(in, m_perm.data(),
+                                               m_iwork.data());
+      break;
+    default:
+      m_structure.greedy_fill_reducing_permutation(in, m_perm.data(),
+                                                   m_iwork.data());
+      break;
+    }
+    cache.insert(in, method, m_perm);
+  }
   symbolic_deep_copy(in, m_structure, m_perm.data());
   analyzePattern();
   updateBlockPermutationMatrix(in);
@@ -57,6 +76,55 @@ BlockLDLT<Scalar> &BlockLDLT<Scalar>::updateBlockPermutationMatrix(
   return *this;
 }
 
+template <typename Scalar> isize BlockLDLT<Scalar>::computeUpdateBlock() const {
+  if (m_update_size <= 0)
+    return 0;
+  const isize end = m_update_start + m_update_size;
+  for (usize i = 0; i < nblocks(); ++i) {
+    const auto j = usize(m_perm[i]);
+    const isize i0 = m_start_idx[j];
+    const isize i1 = j + 1 < nblocks() ? m_start_idx[j + 1] : m_matrix.rows();
+    if (i0 < end && m_update_start < i1)
+      return isize(i);
+  }
+  return 0;
+}
+
+template <typename Scalar> void BlockLDLT<Scalar>::factorizeTrailing() {
+  const isize rem = m_schur.rows();
+  const isize nb = isize(nblocks()) - m_update_block;
+  MatrixRef trailing = m_matrix.bottomRightCorner(rem, rem);
+  SignMatrix trailing_sign = SignMatrix::ZeroSign;
+  m_info = backend::block_impl<Scalar>{trailing,
+                                       m_structure.submatrix(m_update_block,
+                                                             nb),
+                                       m_num_threads}
+                   .ldlt_in_place_impl(trailing_sign)
+               ? Eigen::Success
+               : Eigen::NumericalIssue;
+  m_sign = m_lead_sign;
+  for (isize i = 0; i < rem; ++i)
+    backend::update_sign_matrix(m_sign, trailing(i, i));
+}
+
+template <typename Scalar>
+bool BlockLDLT<Scalar>::updateDiagonal(const Scalar shift) {
+  if (!m_has_schur)
+    return false;
+  const isize n = m_matrix.rows();
+  const isize rem = m_schur.rows();
+  const isize offset = n - rem;
+  const isize end = m_update_start + m_update_size;
+  const auto &indices = permutationP().indices();
+  for (isize i = offset; i < n; ++i) {
+    if (m_update_start <= indices[i] && indices[i] < end)
+      m_schur(i - offset, i - offset) += shift;
+  }
+  m_matrix.bottomRightCorner(rem, rem) = m_schur;
+  factorizeTrailing();
+  return true;
+}
+
 template <typename Scalar>
 typename BlockLDLT<Scalar>::MatrixXs
 BlockLDLT<Scalar>::reconstructedMatrix() const {
@@ -73,7 +141,11 @@ template <typename Scalar>
 template <typename Derived>
 bool BlockLDLT<Scalar>::solveInPlace(Eigen::MatrixBase<Derived> &b) const {
 
-  b.noalias() = permutationP().transpose() * b;
+  // permute through a buffer, since in-place permutations allocate
+  for (isize j = 0; j < b.cols(); ++j) {
+    m_perm_buf.noalias() = permutationP().transpose() * b.col(j);
+    b.col(j) = m_perm_buf;
+  }
   PROXSUITE_NLP_NOMALLOC_BEGIN;
   BlockTriL mat_blk_L(m_matrix, m_structure);
   bool flag = mat_blk_L.solveInPlace(b);
@@ -93,7 +165,10 @@ bool BlockLDLT<Scalar>::solveInPlace(Eigen::MatrixBase<Derived> &b) const {
   flag |= mat_blk_U.solveInPlace(b);
 
   PROXSUITE_NLP_NOMALLOC_END;
-  b.noalias() = permutationP() * b;
+  for (isize j = 0; j < b.cols(); ++j) {
+    m_perm_buf.noalias() = permutationP() * b.col(j);
+    b.col(j) = m_perm_buf;
+  }
   return flag;
 }
 
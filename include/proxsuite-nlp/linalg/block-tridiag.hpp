@@ -0,0 +1,179 @@
+/// @file
+/// @copyright Copyright (C) 2024 LAAS-CNRS, INRIA
+#pragma once
+
+#include "proxsuite-nlp/linalg/dense.hpp"
+
+#include <vector>
+
+namespace proxsuite {
+namespace nlp {
+namespace linalg {
+
+/// @brief  Block-tridiagonal LDLT factorization, for KKT systems with a
+/// stage-wise structure (e.g. multiple-shooting trajectory problems).
+///
+/// @details  The rows of the input matrix are reordered into stages, given by
+/// a permutation and the stage dimensions. In this ordering, the matrix is
+/// assumed to be block-tridiagonal: entries coupling two stages which are not
+/// consecutive are ignored. The factorization is the backward Riccati-like
+/// recursion
+/// \f[
+///   S_0 = A_{00}, \quad
+///   S_k = A_{kk} - A_{k,k-1} S_{k-1}^{-1} A_{k,k-1}^\top,
+/// \f]
+/// where each Schur complement \f$S_k\f$ is factorized with a dense LDLT, so
+/// that the cost is linear in the number of stages. The inertia of the matrix
+/// is the sum of the inertias of the \f$S_k\f$, and vectorD() holds their
+/// diagonal factors in stage order. Like DenseLDLT, this does not pivot.
+template <typename Scalar> struct BlockTridiagLDLT : ldlt_base<Scalar> {
+  PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
+  using Base = ldlt_base<Scalar>;
+  using DView = typename Base::DView;
+  using Base::m_info;
+  using Base::m_sign;
+
+  /// @param perm        Permutation: row @p i of the stage-ordered matrix is
+  /// row `perm[i]` of the input.
+  /// @param stage_dims  Dimensions of the stages.
+  BlockTridiagLDLT(const std::vector<isize> &perm,
+                   const std::vector<isize> &stage_dims)
+      : m_perm(perm), m_stage_start(stage_dims.size() + 1, 0),
+        m_diag(stage_dims.size()), m_sub(stage_dims.size()),
+        m_gain(stage_dims.size()), m_vecD(VectorXs::Zero(isize(perm.size()))),
+        m_work(isize(perm.size())) {
+    for (std::size_t k = 0; k < stage_dims.size(); k++) {
+      const isize nk = stage_dims[k];
+      m_stage_start[k + 1] = m_stage_start[k] + nk;
+      m_diag[k].setZero(nk, nk);
+      if (k > 0) {
+        const isize nprev = stage_dims[k - 1];
+        m_sub[k].setZero(nk, nprev);
+        m_gain[k].setZero(nprev, nk);
+      }
+    }
+    if (m_stage_start.back() != isize(perm.size()))
+      PROXSUITE_NLP_RUNTIME_ERROR(
+          "Stage dimensions do not sum up to the permutation size.");
+  }
+
+  BlockTridiagLDLT &compute(const ConstMatrixRef &mat) {
+    const std::size_t nstages = numStages();
+    m_sign = SignMatrix::ZeroSign;
+    for (std::size_t k = 0; k < nstages; k++) {
+      gather(mat, k, k, m_diag[k]);
+      if (k > 0) {
+        // S_k = A_kk - B_k S_{k-1}^{-1} B_k^T
+        gather(mat, k, k - 1, m_sub[k]);
+        m_gain[k] = m_sub[k].transpose();
+        backend::dense_ldlt_solve_in_place(m_diag[k - 1], m_gain[k]);
+        m_diag[k].noalias() -= m_sub[k] * m_gain[k];
+      }
+      SignMatrix stage_sign = SignMatrix::ZeroSign;
+      backend::dense_ldlt_in_place(m_diag[k], stage_sign);
+      const auto dk = m_diag[k].diagonal();
+      m_vecD.segment(stageStart(k), stageDim(k)) = dk;
+      for (isize i = 0; i < dk.size(); i++)
+        backend::update_sign_matrix(m_sign, dk(i));
+    }
+    m_info = m_vecD.allFinite() ? Eigen::Success : Eigen::NumericalIssue;
+    return *this;
+  }
+
+  template <typename Derived>
+  bool solveInPlace(Eigen::MatrixBase<Derived> &b) const {
+    const std::size_t nstages = numStages();
+    for (isize j = 0; j < b.cols(); j++) {
+      for (isize i = 0; i < b.rows(); i++)
+        m_work(i) = b(m_perm[std::size_t(i)], j);
+      // forward pass
+      for (std::size_t k = 1; k < nstages; k++) {
+        m_work.segment(stageStart(k), stageDim(k)).noalias() -=
+            m_gain[k].transpose() *
+            m_work.segment(stageStart(k - 1), stageDim(k - 1));
+      }
+      for (std::size_t k = 0; k < nstages; k++) {
+        auto wk = m_work.segment(stageStart(k), stageDim(k));
+        backend::dense_ldlt_solve_in_place(m_diag[k], wk);
+      }
+      // backward pass
+      for (std::size_t k = nstages - 1; k > 0; k--) {
+        m_work.segment(stageStart(k - 1), stageDim(k - 1)).noalias() -=
+            m_gain[k] * m_work.segment(stageStart(k), stageDim(k));
+      }
+      for (isize i = 0; i < b.rows(); i++)
+        b(m_perm[std::size_t(i)], j) = m_work(i);
+    }
+    return true;
+  }
+
+  inline DView vectorD() const {
+    return {m_vecD.data(), m_vecD.size(), 1,
+            Eigen::InnerStride<Eigen::Dynamic>{1}};
+  }
+
+  MatrixXs reconstructedMatrix() const {
+    const isize n = m_vecD.size();
+    const std::size_t nstages = numStages();
+    MatrixXs res(n, n);
+    res.setZero();
+    for (std::size_t k = 0; k < nstages; k++) {
+      const isize nk = stageDim(k);
+      MatrixXs akk = MatrixXs::Identity(nk, nk);
+      backend::dense_ldlt_reconstruct<Scalar>(m_diag[k], akk);
+      if (k > 0) {
+        akk.noalias() += m_sub[k] * m_gain[k];
+        const isize nprev = stageDim(k - 1);
+        for (isize i = 0; i < nk; i++) {
+          for (isize l = 0; l < nprev; l++) {
+            const isize r = m_perm[std::size_t(stageStart(k) + i)];
+            const isize c = m_perm[std::size_t(stageStart(k - 1) + l)];
+            res(r, c) = res(c, r) = m_sub[k](i, l);
+          }
+        }
+      }
+      for (isize i = 0; i < nk; i++) {
+        for (isize l = 0; l < nk; l++) {
+          res(m_perm[std::size_t(stageStart(k) + i)],
+              m_perm[std::size_t(stageStart(k) + l)]) = akk(i, l);
+        }
+      }
+    }
+    return res;
+  }
+
+  std::size_t numStages() const { return m_diag.size(); }
+  isize stageStart(std::size_t k) const { return m_stage_start[k]; }
+  isize stageDim(std::size_t k) const {
+    return m_stage_start[k + 1] - m_stage_start[k];
+  }
+  const std::vector<isize> &permutation() const { return m_perm; }
+
+protected:
+  std::vector<isize> m_perm;
+  std::vector<isize> m_stage_start;
+  /// Factorized Schur complements \f$S_k\f$.
+  std::vector<MatrixXs> m_diag;
+  /// Subdiagonal blocks \f$A_{k,k-1}\f$.
+  std::vector<MatrixXs> m_sub;
+  /// Gains \f$S_{k-1}^{-1} A_{k,k-1}^\top\f$.
+  std::vector<MatrixXs> m_gain;
+  VectorXs m_vecD;
+  mutable VectorXs m_work;
+
+  /// Copy the block (k, l) of the stage-ordered input matrix into @p out.
+  void gather(const ConstMatrixRef &mat, std::size_t k, std::size_t l,
+              MatrixXs &out) const {
+    const isize rk = stageStart(k);
+    const isize cl = stageStart(l);
+    for (isize c = 0; c < out.cols(); c++) {
+      const isize jc = m_perm[std::size_t(cl + c)];
+      for (isize r = 0; r < out.rows(); r++)
+        out(r, c) = mat(m_perm[std::size_t(rk + r)], jc);
+    }
+  }
+};
+
+} // namespace linalg
+} // namespace nlp
+} // namespace proxsuite
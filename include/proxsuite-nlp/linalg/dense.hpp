@@ -6,6 +6,9 @@
 #pragma once
 
 #include "proxsuite-nlp/linalg/ldlt-base.hpp"
+#include "proxsuite-nlp/threads.hpp"
+
+#include <vector>
 
 namespace proxsuite {
 namespace nlp {
@@ -88,38 +91,90 @@ inline bool ldlt_in_place_unblocked(Eigen::MatrixBase<Derived> &a,
 
 static constexpr isize UNBLK_THRESHOLD = 128;
 
-/// A recursive, in-place implementation of the LDLT decomposition.
-/// To be applied to dense blocks.
 template <typename Derived>
-inline bool dense_ldlt_in_place(Eigen::MatrixBase<Derived> &a,
-                                SignMatrix &sign) {
+inline bool dense_ldlt_in_place(Eigen::MatrixBase<Derived> &a, SignMatrix &sign,
+                                std::size_t nthreads = 1);
+
+/// Factorize the leading @p bs rows of @param a, and apply the corresponding
+/// (Schur complement) update to the trailing block, which is left to be
+/// factorized.
+/// @param nthreads  Number of threads for the row-panel solves and trailing
+/// updates (requires OpenMP support).
+template <typename Derived>
+inline bool dense_ldlt_eliminate_leading(Eigen::MatrixBase<Derived> &a,
+                                         const isize bs, SignMatrix &sign,
+                                         std::size_t nthreads = 1) {
   using PlainObject = typename Derived::PlainObject;
   using MatrixRef = Eigen::Ref<PlainObject>;
   const isize n = a.rows();
-  if (n <= UNBLK_THRESHOLD) {
-    return backend::ldlt_in_place_unblocked(a, sign);
-  } else {
-    const isize bs = (n + 1) / 2;
-    const isize rem = n - bs;
+  const isize rem = n - bs;
 
-    MatrixRef l00 = a.block(0, 0, bs, bs);
-    Eigen::Block<Derived> l10 = a.block(bs, 0, rem, bs);
-    MatrixRef l11 = a.block(bs, bs, rem, rem);
+  MatrixRef l00 = a.block(0, 0, bs, bs);
+  Eigen::Block<Derived> l10 = a.block(bs, 0, rem, bs);
+  MatrixRef l11 = a.block(bs, bs, rem, rem);
 
-    backend::dense_ldlt_in_place(l00, sign);
-    auto d0 = l00.diagonal();
+  bool flag = backend::dense_ldlt_in_place(l00, sign, nthreads);
+  if (rem == 0)
+    return flag;
+  auto d0 = l00.diagonal();
+  auto work = a.block(0, bs, bs, rem).transpose();
 
+  if (nthreads <= 1) {
     l00.transpose()
         .template triangularView<Eigen::UnitUpper>()
         .template solveInPlace<Eigen::OnTheRight>(l10);
 
-    auto work = a.block(0, bs, bs, rem).transpose();
     work = l10;
     l10 = l10 * d0.asDiagonal().inverse();
 
     l11.template triangularView<Eigen::Lower>() -= l10 * work.transpose();
+  } else {
+    // the rows of l10 are independent, and so are the column panels of the
+    // trailing update
+    const isize npanels = std::min(isize(4 * nthreads), rem);
+    PROXSUITE_NLP_OMP_PARALLEL_FOR(nthreads)
+    for (isize p = 0; p < npanels; ++p) {
+      const isize r0 = p * rem / npanels;
+      const isize nr = (p + 1) * rem / npanels - r0;
+      auto l10_p = l10.middleRows(r0, nr);
+      l00.transpose()
+          .template triangularView<Eigen::UnitUpper>()
+          .template solveInPlace<Eigen::OnTheRight>(l10_p);
+      work.middleRows(r0, nr) = l10_p;
+      l10_p = l10_p * d0.asDiagonal().inverse();
+    }
+    PROXSUITE_NLP_OMP_PARALLEL_FOR(nthreads)
+    for (isize p = 0; p < npanels; ++p) {
+      const isize c0 = p * rem / npanels;
+      const isize nc = (p + 1) * rem / npanels - c0;
+      const isize below = rem - c0 - nc;
+      l11.block(c0, c0, nc, nc).template triangularView<Eigen::Lower>() -=
+          l10.middleRows(c0, nc) * work.middleRows(c0, nc).transpose();
+      l11.block(c0 + nc, c0, below, nc).noalias() -=
+          l10.bottomRows(below) * work.middleRows(c0, nc).transpose();
+    }
+  }
+  return flag;
+}
 
-    return backend::dense_ldlt_in_place(l11, sign);
+/// A recursive, in-place implementation of the LDLT decomposition.
+/// To be applied to dense blocks.
+/// @param nthreads  Number of threads for the row-panel solves and trailing
+/// updates (requires OpenMP support).
+template <typename Derived>
+inline bool dense_ldlt_in_place(Eigen::MatrixBase<Derived> &a, SignMatrix &sign,
+                                std::size_t nthreads) {
+  using PlainObject = typename Derived::PlainObject;
+  using MatrixRef = Eigen::Ref<PlainObject>;
+  const isize n = a.rows();
+  if (n <= UNBLK_THRESHOLD) {
+    return backend::ldlt_in_place_unblocked(a, sign);
+  } else {
+    const isize bs = (n + 1) / 2;
+    const isize rem = n - bs;
+    backend::dense_ldlt_eliminate_leading(a, bs, sign, nthreads);
+    MatrixRef l11 = a.block(bs, bs, rem, rem);
+    return backend::dense_ldlt_in_place(l11, sign, nthreads);
   }
 }
 
@@ -173,39 +228,148 @@ template <typename Scalar> struct DenseLDLT : ldlt_base<Scalar> {
   }
 
   explicit DenseLDLT(MatrixRef a) : Base(), m_matrix(a) {
-    m_info = backend::dense_ldlt_in_place(m_matrix, m_sign)
+    m_info = backend::dense_ldlt_in_place(m_matrix, m_sign, m_num_threads)
                  ? Eigen::Success
                  : Eigen::NumericalIssue;
   }
 
   DenseLDLT &compute(const ConstMatrixRef &mat) {
-    m_matrix = mat;
-    m_info = backend::dense_ldlt_in_place(m_matrix, m_sign)
-                 ? Eigen::Success
-                 : Eigen::NumericalIssue;
+    const isize n = mat.rows();
+    const isize start = std::min(m_update_start, n);
+    const isize size = std::min(m_update_size, n - start);
+    if (size == 0 || size == n) {
+      m_permutation.resize(0);
+      m_has_schur = false;
+      m_matrix = mat;
+      m_info = backend::dense_ldlt_in_place(m_matrix, m_sign, m_num_threads)
+                   ? Eigen::Success
+                   : Eigen::NumericalIssue;
+      return *this;
+    }
+
+    // order the updatable rows last, unless they already are
+    const isize split = n - size;
+    m_matrix.resize(n, n);
+    if (start == split) {
+      m_permutation.resize(0);
+      m_matrix = mat;
+    } else {
+      m_permutation.resize(n);
+      auto &indices = m_permutation.indices();
+      for (isize i = 0; i < split; ++i)
+        indices(i) = i < start ? i : i + size;
+      for (isize i = 0; i < size; ++i)
+        indices(split + i) = start + i;
+      // P^T A P, permuting the rows through a buffer since in-place
+      // permutations allocate
+      m_work.resize(n);
+      m_matrix.noalias() = mat * m_permutation;
+      for (isize j = 0; j < n; ++j) {
+        m_work.noalias() = m_permutation.transpose() * m_matrix.col(j);
+        m_matrix.col(j) = m_work;
+      }
+    }
+    // keep the Schur complement w.r.t. the leading rows, for updateDiagonal()
+    m_sign = SignMatrix::ZeroSign;
+    backend::dense_ldlt_eliminate_leading(m_matrix, split, m_sign,
+                                          m_num_threads);
+    m_lead_sign = m_sign;
+    m_schur = m_matrix.bottomRightCorner(size, size);
+    m_has_schur = true;
+    factorizeTrailing();
     return *this;
   }
 
+  /// @brief Set the rows (of the input matrix) whose diagonal entries may be
+  /// shifted by updateDiagonal().
+  /// @details  compute() then symmetrically permutes these rows to the end,
+  /// factorizes the other rows first, and keeps the Schur complement of the
+  /// trailing block. For a KKT matrix, the primal rows can be set, so that the
+  /// dual block is eliminated first. The factors given by matrixLDLT() and
+  /// vectorD() are those of the permuted matrix.
+  void setUpdatableRows(isize start, isize size) {
+    m_update_start = start;
+    m_update_size = size;
+    m_has_schur = false;
+  }
+
+  /// @brief Add @p shift to the diagonal of the rows set by
+  /// setUpdatableRows(), by only refactorizing the trailing block.
+  /// @returns whether the update could be performed; otherwise, the matrix
+  /// should be factorized again with compute().
+  bool updateDiagonal(const Scalar shift) {
+    if (!m_has_schur)
+      return false;
+    const isize rem = m_schur.rows();
+    m_schur.diagonal().array() += shift;
+    m_matrix.bottomRightCorner(rem, rem) = m_schur;
+    factorizeTrailing();
+    return true;
+  }
+
   const MatrixXs &matrixLDLT() const { return m_matrix; }
 
   template <typename Derived>
   bool solveInPlace(Eigen::MatrixBase<Derived> &b) const {
-    return backend::dense_ldlt_solve_in_place(m_matrix, b);
+    if (m_permutation.size() == 0)
+      return backend::dense_ldlt_solve_in_place(m_matrix, b);
+    for (isize j = 0; j < b.cols(); ++j) {
+      m_work.noalias() = m_permutation.transpose() * b.col(j);
+      backend::dense_ldlt_solve_in_place(m_matrix, m_work);
+      b.col(j).noalias() = m_permutation * m_work;
+    }
+    return true;
   }
 
   MatrixXs reconstructedMatrix() const {
-    MatrixXs res(m_matrix.rows(), m_matrix.cols());
+    const isize n = m_matrix.rows();
+    MatrixXs res(n, n);
     res.setIdentity();
     backend::dense_ldlt_reconstruct<Scalar>(m_matrix, res);
+    if (m_permutation.size() == 0)
+      return res;
+    MatrixXs out(n, n);
+    out.noalias() = m_permutation * res;
+    res.noalias() = out * m_permutation.transpose();
     return res;
   }
 
   inline DView vectorD() const { return Base::diag_view_impl(m_matrix); }
 
+  /// Set the number of threads used by the factorization.
+  void setNumThreads(std::size_t num_threads) { m_num_threads = num_threads; }
+  std::size_t getNumThreads() const { return m_num_threads; }
+
 protected:
   MatrixType m_matrix;
+  std::size_t m_num_threads = 1;
+  /// First updatable row, and number of updatable rows.
+  isize m_update_start = 0;
+  isize m_update_size = 0;
+  /// Symmetric permutation \f$ P \f$ of the input, which is factorized as
+  /// \f$ P^\top A P \f$ (empty for the identity).
+  Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, isize>
+      m_permutation;
+  mutable VectorXs m_work;
+  /// Schur complement of the trailing block, before its factorization.
+  MatrixType m_schur;
+  bool m_has_schur = false;
+  /// Sign of the factorization of the leading block.
+  SignMatrix m_lead_sign = SignMatrix::ZeroSign;
   using Base::m_info;
   using Base::m_sign;
+
+  void factorizeTrailing() {
+    const isize rem = m_schur.rows();
+    auto l11 = m_matrix.bottomRightCorner(rem, rem);
+    SignMatrix trailing_sign = SignMatrix::ZeroSign;
+    m_info = backend::dense_ldlt_in_place(l11, trailing_sign, m_num_threads)
+                 ? Eigen::Success
+                 : Eigen::NumericalIssue;
+    m_sign = m_lead_sign;
+    for (isize i = 0; i < rem; ++i)
+      backend::update_sign_matrix(m_sign, l11(i, i));
+  }
 };
 
 } // namespace linalg
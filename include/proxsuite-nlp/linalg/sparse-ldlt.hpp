@@ -0,0 +1,227 @@
+/// @file
+/// @copyright Copyright (C) 2023 LAAS-CNRS, INRIA
+#pragma once
+
+#include "proxsuite-nlp/linalg/ldlt-base.hpp"
+
+#include <Eigen/SparseCore>
+#include <Eigen/SparseCholesky>
+#include <Eigen/OrderingMethods>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace proxsuite {
+namespace nlp {
+namespace linalg {
+
+/// @brief  Sparse LDLT factorization, using Eigen's simplicial LDLT with an
+/// approximate minimum degree (AMD) fill-reducing ordering.
+///
+/// @details  The symbolic analysis (ordering and elimination tree) is kept
+/// across calls to compute(), and only redone when the input matrix has a
+/// nonzero outside of the sparsity pattern seen so far. Entries which vanish
+/// (e.g. inactive constraint rows) are kept as explicit zeros. Only the lower
+/// triangular part of the input is read. The factorization does not pivot: it
+/// is meant for quasi-definite matrices such as the regularized KKT systems
+/// of the solver, for which it reveals the inertia.
+template <typename Scalar> struct SparseLDLT : ldlt_base<Scalar> {
+  PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
+  using Base = ldlt_base<Scalar>;
+  using DView = typename Base::DView;
+  using SparseType = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+  using SolverType = Eigen::SimplicialLDLT<SparseType, Eigen::Lower,
+                                           Eigen::AMDOrdering<int>>;
+  using Triplet = Eigen::Triplet<Scalar>;
+  using Base::m_info;
+
+  explicit SparseLDLT(isize size)
+      : m_mat(size, size), m_solver(std::make_unique<SolverType>()),
+        m_vecD(VectorXs::Zero(size)), m_analyzed(false) {}
+
+  /// Eigen's sparse solvers are not copyable: redo the factorization.
+  SparseLDLT(const SparseLDLT &other)
+      : Base(other), m_mat(other.m_mat),
+        m_solver(std::make_unique<SolverType>()), m_vecD(other.m_vecD),
+        m_analyzed(false) {
+    if (other.m_analyzed)
+      factorize();
+    m_num_analyses = other.m_num_analyses;
+  }
+  SparseLDLT(SparseLDLT &&) = default;
+  SparseLDLT &operator=(SparseLDLT &&) = default;
+
+  SparseLDLT &compute(const ConstMatrixRef &mat) {
+    PROXSUITE_NLP_MALLOC_ALLOWED_SCOPE;
+    if (!m_analyzed || !patternContains(mat))
+      extendPattern(mat);
+    for (isize j = 0; j < m_mat.outerSize(); ++j) {
+      for (typename SparseType::InnerIterator it(m_mat, j); it; ++it)
+        it.valueRef() = mat(it.row(), j);
+    }
+    return factorize();
+  }
+
+  /// @brief  Factorize a matrix given in sparse format (lower triangular part
+  /// is used).
+  SparseLDLT &compute(const SparseType &mat) {
+    PROXSUITE_NLP_MALLOC_ALLOWED_SCOPE;
+    SparseType lower = mat.template triangularView<Eigen::Lower>();
+    if (!m_analyzed || !patternContains(lower))
+      extendPattern(lower);
+    if (samePattern(lower)) {
+      m_mat.coeffs() = lower.coeffs();
+      return factorize();
+    }
+    m_mat.coeffs().setZero();
+    for (isize j = 0; j < lower.outerSize(); ++j) {
+      for (typename SparseType::InnerIterator it(lower, j); it; ++it)
+        m_mat.coeffRef(it.row(), j) = it.value();
+    }
+    return factorize();
+  }
+
+  template <typename Derived>
+  bool solveInPlace(Eigen::MatrixBase<Derived> &b) const {
+    if (m_info != Eigen::Success)
+      return false;
+    PROXSUITE_NLP_MALLOC_ALLOWED_SCOPE;
+    b = m_solver->solve(b);
+    return true;
+  }
+
+  inline DView vectorD() const {
+    return {m_vecD.data(), m_vecD.size(), 1,
+            Eigen::InnerStride<Eigen::Dynamic>{1}};
+  }
+
+  /// @brief  Dense copy of the permuted factor, with @f$ L @f$ in the
+  /// strict lower part and @f$ D @f$ on the diagonal.
+  const MatrixXs &matrixLDLT() const override {
+    m_dense_ldlt = MatrixXs(m_solver->matrixL().nestedExpression());
+    m_dense_ldlt.diagonal() = m_vecD;
+    return m_dense_ldlt;
+  }
+
+  MatrixXs reconstructedMatrix() const {
+    MatrixXs L = matrixLDLT().template triangularView<Eigen::UnitLower>();
+    MatrixXs res = L * m_vecD.asDiagonal() * L.transpose();
+    return m_solver->permutationPinv() * res * m_solver->permutationP();
+  }
+
+  /// Sparse storage of the lower triangular part of the last input.
+  const SparseType &matrix() const { return m_mat; }
+  /// Number of nonzeros in the analyzed sparsity pattern.
+  isize nonZeros() const { return m_mat.nonZeros(); }
+  /// Number of times the symbolic analysis was performed.
+  std::size_t numAnalyses() const { return m_num_analyses; }
+
+protected:
+  SparseType m_mat;
+  std::unique_ptr<SolverType> m_solver;
+  VectorXs m_vecD;
+  bool m_analyzed;
+  std::size_t m_num_analyses = 0;
+  mutable MatrixXs m_dense_ldlt;
+
+  SparseLDLT &factorize() {
+    if (!m_analyzed) {
+      m_solver->analyzePattern(m_mat);
+      m_analyzed = true;
+      m_num_analyses++;
+    }
+    m_solver->factorize(m_mat);
+    m_info = m_solver->info();
+    if (m_info == Eigen::Success)
+      m_vecD = m_solver->vectorD();
+    else
+      m_vecD.setZero();
+    return *this;
+  }
+
+  /// Check whether the nonzeros of the lower part of @p mat are in the current
+  /// pattern.
+  bool patternContains(const ConstMatrixRef &mat) const {
+    const isize n = m_mat.cols();
+    for (isize j = 0; j < n; ++j) {
+      typename SparseType::InnerIterator it(m_mat, j);
+      for (isize i = j; i < n; ++i) {
+        if (mat(i, j) == Scalar(0))
+          continue;
+        while (it && it.row() < i)
+          ++it;
+        if (!it || it.row() != i)
+          return false;
+      }
+    }
+    return true;
+  }
+
+  /// Whether the compressed matrix @p lower has exactly the current pattern,
+  /// so that its values can be copied over.
+  bool samePattern(const SparseType &lower) const {
+    const isize n = m_mat.outerSize();
+    if (!lower.isCompressed() || lower.outerSize() != n ||
+        lower.nonZeros() != m_mat.nonZeros())
+      return false;
+    return std::equal(m_mat.outerIndexPtr(), m_mat.outerIndexPtr() + n + 1,
+                      lower.outerIndexPtr()) &&
+           std::equal(m_mat.innerIndexPtr(),
+                      m_mat.innerIndexPtr() + m_mat.nonZeros(),
+                      lower.innerIndexPtr());
+  }
+
+  bool patternContains(const SparseType &lower) const {
+    for (isize j = 0; j < lower.outerSize(); ++j) {
+      typename SparseType::InnerIterator it(m_mat, j);
+      for (typename SparseType::InnerIterator jt(lower, j); jt; ++jt) {
+        while (it && it.row() < jt.row())
+          ++it;
+        if (!it || it.row() != jt.row())
+          return false;
+      }
+    }
+    return true;
+  }
+
+  /// Replace the pattern by its union with the nonzeros of @p mat. The
+  /// diagonal is always part of the pattern, so that diagonal shifts never
+  /// trigger a new analysis.
+  template <typename MatType> void extendPattern(const MatType &mat) {
+    const isize n = m_mat.cols();
+    std::vector<Triplet> triplets;
+    triplets.reserve(std::size_t(m_mat.nonZeros() + n));
+    for (isize j = 0; j < n; ++j) {
+      triplets.emplace_back(j, j, Scalar(0));
+      for (typename SparseType::InnerIterator it(m_mat, j); it; ++it)
+        triplets.emplace_back(it.row(), j, Scalar(0));
+    }
+    appendNonZeros(mat, triplets);
+    m_mat.setFromTriplets(triplets.begin(), triplets.end());
+    m_mat.makeCompressed();
+    m_analyzed = false;
+  }
+
+  static void appendNonZeros(const ConstMatrixRef &mat,
+                             std::vector<Triplet> &triplets) {
+    for (isize j = 0; j < mat.cols(); ++j) {
+      for (isize i = j; i < mat.rows(); ++i) {
+        if (mat(i, j) != Scalar(0))
+          triplets.emplace_back(i, j, Scalar(0));
+      }
+    }
+  }
+
+  static void appendNonZeros(const SparseType &lower,
+                             std::vector<Triplet> &triplets) {
+    for (isize j = 0; j < lower.outerSize(); ++j) {
+      for (typename SparseType::InnerIterator it(lower, j); it; ++it)
+        triplets.emplace_back(it.row(), j, Scalar(0));
+    }
+  }
+};
+
+} // namespace linalg
+} // namespace nlp
+} // namespace proxsuite
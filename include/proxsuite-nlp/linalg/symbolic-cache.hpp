@@ -0,0 +1,80 @@
+/// @file
+/// @brief  Cache for the symbolic analysis of block-sparse matrices.
+/// @copyright Copyright (C) 2024 LAAS-CNRS, INRIA
+#pragma once
+
+#include "proxsuite-nlp/linalg/block-kind.hpp"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace proxsuite {
+namespace nlp {
+namespace linalg {
+
+/// Hash of the block sizes and sparsity pattern of a SymbolicBlockMatrix.
+PROXSUITE_NLP_DLLAPI std::size_t
+hash_structure(const SymbolicBlockMatrix &in) noexcept;
+
+/// @brief  Process-wide cache of the block permutations found by
+/// BlockLDLT::findSparsifyingPermutation().
+///
+/// @details  Entries are keyed by the block structure (block sizes and
+/// sparsity pattern) and the ordering method. On a cache hit, the permutation
+/// search is skipped, and only the (cheap) symbolic factorization of the
+/// permuted structure is redone. The cache can be saved to and loaded from a
+/// file, so that new processes can skip the search for known problem shapes.
+/// All member functions are thread-safe.
+class PROXSUITE_NLP_DLLAPI SymbolicAnalysisCache {
+public:
+  /// The global cache instance.
+  static SymbolicAnalysisCache &instance();
+
+  /// Look up the permutation for structure @p in and ordering @p method.
+  /// @returns whether it was found.
+  bool find(const SymbolicBlockMatrix &in, BlockOrdering method,
+            std::vector<isize> &perm) const;
+  /// Store the permutation @p perm for structure @p in and ordering @p method.
+  void insert(const SymbolicBlockMatrix &in, BlockOrdering method,
+              const std::vector<isize> &perm);
+
+  std::size_t size() const;
+  void clear();
+
+  /// Enable or disable lookups and insertions (enabled by default).
+  void setEnabled(bool enabled);
+  bool enabled() const;
+
+  /// Save the cache to a file, using Boost.Serialization.
+  void save(const std::string &filename) const;
+  /// Load cache entries from a file, and merge them into the cache.
+  void load(const std::string &filename);
+
+  /// A cached symbolic analysis.
+  struct Entry {
+    int method;
+    std::vector<isize> segment_lens;
+    std::vector<int> pattern;
+    std::vector<isize> perm;
+
+    bool matches(const SymbolicBlockMatrix &in, BlockOrdering m) const;
+    template <class Archive> void serialize(Archive &ar, const unsigned int) {
+      ar &method;
+      ar &segment_lens;
+      ar &pattern;
+      ar &perm;
+    }
+  };
+
+private:
+  void insertEntry(std::size_t key, Entry &&entry);
+
+  std::unordered_multimap<std::size_t, Entry> m_entries;
+  bool m_enabled = true;
+  mutable std::mutex m_mutex;
+};
+
+} // namespace linalg
+} // namespace nlp
+} // namespace proxsuite
@@ -227,5 +227,70 @@ protected:
   DecompType decomp;
 };
 
+/// @brief  Speculative Armijo line-search strategy.
+///
+/// @details  Instead of backtracking one step at a time, this evaluates a
+/// geometric ladder \f$\alpha_k = \tau^k\f$ (with \f$\tau\f$ the minimal
+/// contraction factor) of @p num_candidates step sizes at once, so that the
+/// caller can evaluate them concurrently. The largest step size satisfying the
+/// Armijo condition is selected; if there is none, the next rungs of the
+/// ladder are tried.
+template <typename Scalar>
+class SpeculativeArmijoLinesearch final : public Linesearch<Scalar> {
+public:
+  using Base = Linesearch<Scalar>;
+
+  SpeculativeArmijoLinesearch(const typename Base::Options &options,
+                              std::size_t num_candidates)
+      : Base(options), alphas(std::max(num_candidates, std::size_t(1))),
+        values(alphas.size()) {}
+
+  /// @param phi_batch  Callable with signature `void(const
+  /// std::vector<Scalar> &alphas, std::vector<Scalar> &values)` evaluating the
+  /// merit function at the given step sizes. Failed evaluations should be
+  /// reported as non-finite values.
+  template <typename Fn>
+  Scalar run(Fn phi_batch, const Scalar phi0, const Scalar dphi0,
+             Scalar &alpha_try) {
+    const Scalar tau = options().contraction_min;
+    const Scalar alpha_min = options().alpha_min;
+    const bool check_decrease = std::abs(dphi0) >= options().dphi_thresh;
+    Scalar alpha = 1.;
+    std::size_t num_steps = 0;
+
+    while (true) {
+      bool last_batch = false;
+      for (std::size_t k = 0; k < alphas.size(); k++) {
+        alphas[k] = std::max(alpha, alpha_min);
+        last_batch = last_batch || (alpha <= alpha_min);
+        alpha *= tau;
+      }
+      phi_batch(alphas, values);
+      num_steps += alphas.size();
+
+      for (std::size_t k = 0; k < alphas.size(); k++) {
+        if (!std::isfinite(values[k]))
+          continue;
+        const Scalar dM = values[k] - phi0;
+        if (!check_decrease ||
+            dM <= options().armijo_c1 * alphas[k] * dphi0) {
+          alpha_try = alphas[k];
+          return values[k];
+        }
+      }
+      if (last_batch || num_steps > options().max_num_steps)
+        break;
+    }
+    // no acceptable step: take the smallest one
+    alpha_try = alphas.back();
+    return values.back();
+  }
+
+protected:
+  using Base::options;
+  std::vector<Scalar> alphas;
+  std::vector<Scalar> values;
+};
+
 } // namespace nlp
 } // namespace proxsuite
@@ -35,6 +35,7 @@ public:
     friend std::ostream &operator<<(std::ostream &oss, const Options &self) {
       oss << "{";
       oss << fmt::format("armijo_c1 = {:.3e}", self.armijo_c1);
+      oss << ", " << fmt::format("wolfe_c2 = {:.3e}", self.wolfe_c2);
       oss << ", "
           << fmt::format("contraction_min = {:.3e}", self.contraction_min);
       oss << ", "
@@ -73,6 +74,7 @@ template <typename T> Linesearch<T>::~Linesearch() = default;
 } // namespace proxsuite
 
 #include "proxsuite-nlp/linesearch-armijo.hpp"
+#include "proxsuite-nlp/linesearch-wolfe.hpp"
 
 #ifdef PROXSUITE_NLP_ENABLE_TEMPLATE_INSTANTIATION
 #include "proxsuite-nlp/linesearch.txx"
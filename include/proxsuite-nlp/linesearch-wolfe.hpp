@@ -0,0 +1,147 @@
+/// @file linesearch-wolfe.hpp
+/// @copyright Copyright (C) 2024 LAAS-CNRS, INRIA
+/// @brief  Implements a line-search strategy for the strong Wolfe conditions.
+#pragma once
+
+#include "proxsuite-nlp/linesearch-base.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace proxsuite {
+namespace nlp {
+
+/// @brief  Line-search strategy enforcing the strong Wolfe conditions.
+///
+/// @details  This is the bracketing and zoom procedure of Nocedal & Wright
+/// (Algorithms 3.5 and 3.6). Trial steps are capped at the full step
+/// \f$\alpha = 1\f$, which is accepted whenever it gives sufficient decrease.
+/// Inside a bracket, new trial steps are obtained by safeguarded interpolation
+/// of the values and derivatives at its endpoints.
+template <typename Scalar>
+class WolfeLinesearch final : public Linesearch<Scalar> {
+public:
+  using Base = Linesearch<Scalar>;
+  using FunctionSample = typename Base::FunctionSample;
+
+  WolfeLinesearch(const typename Base::Options &options) : Base(options) {}
+
+  /// @param phi    Callable with signature `Scalar(Scalar alpha, Scalar
+  /// &dphi)`, returning the merit value and setting its derivative.
+  /// @param phi0   Merit value at \f$\alpha = 0\f$.
+  /// @param dphi0  Merit directional derivative at \f$\alpha = 0\f$.
+  /// @param[out] alpha_try  Accepted step size.
+  template <typename Fn>
+  Scalar run(Fn phi, const Scalar phi0, const Scalar dphi0, Scalar &alpha_try) {
+    const FunctionSample lower_bound(0., phi0, dphi0);
+
+    alpha_try = 1.;
+    FunctionSample latest = sample(phi, alpha_try);
+
+    if (std::abs(dphi0) < options().dphi_thresh) {
+      return latest.phi;
+    }
+
+    // bracketing phase: only one trial step since the step is capped at 1
+    if (!sufficientDecrease(latest, lower_bound)) {
+      latest = zoom(phi, lower_bound, lower_bound, latest);
+    } else if (!curvatureCondition(latest, lower_bound) && latest.dphi > 0.) {
+      latest = zoom(phi, lower_bound, latest, lower_bound);
+    }
+
+    if (latest.alpha < options().alpha_min) {
+      latest = sample(phi, options().alpha_min);
+    }
+    alpha_try = latest.alpha;
+    return latest.phi;
+  }
+
+protected:
+  using Base::options;
+
+  /// Evaluate the merit function; evaluation failures are turned into an
+  /// infinite value, which triggers a contraction of the bracket.
+  template <typename Fn> static FunctionSample sample(Fn &phi, Scalar alpha) {
+    try {
+      Scalar dphi = 0.;
+      Scalar val = phi(alpha, dphi);
+      return FunctionSample(alpha, val, dphi);
+    } catch (const std::runtime_error &) {
+      FunctionSample res(alpha, std::numeric_limits<Scalar>::infinity(), 0.);
+      res.valid = false;
+      return res;
+    }
+  }
+
+  bool sufficientDecrease(const FunctionSample &s,
+                          const FunctionSample &s0) const {
+    return s.valid &&
+           (s.phi - s0.phi <= options().armijo_c1 * s.alpha * s0.dphi);
+  }
+
+  bool curvatureCondition(const FunctionSample &s,
+                          const FunctionSample &s0) const {
+    return std::abs(s.dphi) <= -options().wolfe_c2 * s0.dphi;
+  }
+
+  /// Zoom into the bracket \f$[\alpha_{lo}, \alpha_{hi}]\f$, where the low
+  /// endpoint satisfies the sufficient decrease condition. Returns the last
+  /// such low endpoint if the iteration budget is exhausted.
+  template <typename Fn>
+  FunctionSample zoom(Fn &phi, const FunctionSample &s0, FunctionSample lo,
+                      FunctionSample hi) const {
+    for (std::size_t i = 0; i < options().max_num_steps; i++) {
+      if (std::abs(hi.alpha - lo.alpha) < options().alpha_min)
+        break;
+      const FunctionSample cand = sample(phi, interpolate(lo, hi));
+      if (!sufficientDecrease(cand, s0) || cand.phi >= lo.phi) {
+        hi = cand;
+      } else {
+        if (curvatureCondition(cand, s0))
+          return cand;
+        if (cand.dphi * (hi.alpha - lo.alpha) >= 0.)
+          hi = lo;
+        lo = cand;
+      }
+    }
+    return lo;
+  }
+
+  /// Safeguarded minimizer of the interpolant of the bracket endpoints.
+  Scalar interpolate(const FunctionSample &lo, const FunctionSample &hi) const {
+    const Scalar width = hi.alpha - lo.alpha;
+    const Scalar amin = std::min(lo.alpha, hi.alpha) + 0.1 * std::abs(width);
+    const Scalar amax = std::max(lo.alpha, hi.alpha) - 0.1 * std::abs(width);
+    Scalar anext = lo.alpha + 0.5 * width;
+    if (hi.valid) {
+      switch (options().interp_type) {
+      case LSInterpolation::QUADRATIC: {
+        // value and derivative at lo, value at hi
+        const Scalar a =
+            (hi.phi - lo.phi - lo.dphi * width) / (width * width);
+        anext = lo.alpha - lo.dphi / (2. * a);
+        break;
+      }
+      case LSInterpolation::CUBIC: {
+        // values and derivatives at both ends
+        const Scalar d1 =
+            lo.dphi + hi.dphi - 3. * (lo.phi - hi.phi) / (lo.alpha - hi.alpha);
+        const Scalar d2 = std::copysign(
+            std::sqrt(d1 * d1 - lo.dphi * hi.dphi), width);
+        anext = hi.alpha -
+                width * (hi.dphi + d2 - d1) / (hi.dphi - lo.dphi + 2. * d2);
+        break;
+      }
+      default:
+        break;
+      }
+    }
+    if (!std::isfinite(anext) || anext < amin || anext > amax) {
+      anext = lo.alpha + 0.5 * width;
+    }
+    return anext;
+  }
+};
+
+} // namespace nlp
+} // namespace proxsuite
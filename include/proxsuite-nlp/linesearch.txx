@@ -13,6 +13,10 @@ extern template struct PROXSUITE_NLP_EXPLICIT_INSTANTIATION_DECLARATION_DLLAPI
     PolynomialTpl<context::Scalar>;
 extern template class PROXSUITE_NLP_EXPLICIT_INSTANTIATION_DECLARATION_DLLAPI
     ArmijoLinesearch<context::Scalar>;
+extern template class PROXSUITE_NLP_EXPLICIT_INSTANTIATION_DECLARATION_DLLAPI
+    SpeculativeArmijoLinesearch<context::Scalar>;
+extern template class PROXSUITE_NLP_EXPLICIT_INSTANTIATION_DECLARATION_DLLAPI
+    WolfeLinesearch<context::Scalar>;
 
 } // namespace nlp
 } // namespace proxsuite
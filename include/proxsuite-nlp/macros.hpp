@@ -8,17 +8,109 @@
 #define PROXSUITE_NLP_EIGEN_CONST_CAST(type, obj) const_cast<type &>(obj)
 
 #ifdef PROXSUITE_NLP_EIGEN_CHECK_MALLOC
-#define PROXSUITE_NLP_EIGEN_ALLOW_MALLOC(allowed)                              \
-  ::Eigen::internal::set_is_malloc_allowed(allowed)
+#include <Eigen/Core>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace proxsuite {
+namespace nlp {
+namespace internal {
+
+/// Depth of the nested performance-critical regions, for the calling thread.
+inline int &nomalloc_depth() {
+  static thread_local int depth = 0;
+  return depth;
+}
+
+/// Whether the calling thread may toggle Eigen's malloc flag. The flag is
+/// shared by all threads: it is left untouched inside active OpenMP parallel
+/// regions, over which allocations are not checked (see omp::parallel_for()).
+inline bool nomalloc_owns_flag() {
+#ifdef _OPENMP
+  return !omp_in_parallel();
 #else
-#define PROXSUITE_NLP_EIGEN_ALLOW_MALLOC(allowed)
+  return true;
 #endif
+}
+
+inline void nomalloc_begin() {
+  ++nomalloc_depth();
+  if (nomalloc_owns_flag())
+    ::Eigen::internal::set_is_malloc_allowed(false);
+}
+
+inline void nomalloc_end() {
+  if (--nomalloc_depth() <= 0) {
+    nomalloc_depth() = 0;
+    if (nomalloc_owns_flag())
+      ::Eigen::internal::set_is_malloc_allowed(true);
+  }
+}
 
-/// @brief Entering performance-critical code.
-#define PROXSUITE_NLP_NOMALLOC_BEGIN PROXSUITE_NLP_EIGEN_ALLOW_MALLOC(false)
+/// Allow allocations until the end of the scope, then restore the previous
+/// state.
+struct scoped_malloc_allowed {
+  scoped_malloc_allowed()
+      : owner_(nomalloc_owns_flag()),
+        prev_(::Eigen::internal::is_malloc_allowed()) {
+    if (owner_)
+      ::Eigen::internal::set_is_malloc_allowed(true);
+  }
+  ~scoped_malloc_allowed() {
+    if (owner_)
+      ::Eigen::internal::set_is_malloc_allowed(prev_);
+  }
 
+private:
+  bool owner_;
+  bool prev_;
+};
+
+/// Restore the no-malloc state at the end of the scope, e.g. when an
+/// exception was thrown from inside a performance-critical region.
+struct scoped_nomalloc_state {
+  scoped_nomalloc_state()
+      : owner_(nomalloc_owns_flag()), depth_(nomalloc_depth()),
+        allowed_(::Eigen::internal::is_malloc_allowed()) {}
+  ~scoped_nomalloc_state() {
+    nomalloc_depth() = depth_;
+    if (owner_)
+      ::Eigen::internal::set_is_malloc_allowed(allowed_);
+  }
+
+private:
+  bool owner_;
+  int depth_;
+  bool allowed_;
+};
+
+} // namespace internal
+} // namespace nlp
+} // namespace proxsuite
+
+#define PROXSUITE_NLP_EIGEN_ALLOW_MALLOC(allowed)                              \
+  ::Eigen::internal::set_is_malloc_allowed(allowed)
+/// @brief Allow allocations in the current scope, e.g. to call into a
+/// routine which is known to allocate from inside performance-critical code.
+#define PROXSUITE_NLP_MALLOC_ALLOWED_SCOPE                                     \
+  ::proxsuite::nlp::internal::scoped_malloc_allowed _proxsuite_nlp_malloc_scope
+/// @brief Restore the current no-malloc state when leaving the scope, even
+/// through an exception.
+#define PROXSUITE_NLP_NOMALLOC_STATE_SCOPE                                     \
+  ::proxsuite::nlp::internal::scoped_nomalloc_state _proxsuite_nlp_state_scope
+/// @brief Entering performance-critical code. Regions can be nested.
+#define PROXSUITE_NLP_NOMALLOC_BEGIN                                           \
+  ::proxsuite::nlp::internal::nomalloc_begin()
 /// @brief Exiting performance-critical code.
-#define PROXSUITE_NLP_NOMALLOC_END PROXSUITE_NLP_EIGEN_ALLOW_MALLOC(true)
+#define PROXSUITE_NLP_NOMALLOC_END ::proxsuite::nlp::internal::nomalloc_end()
+#else
+#define PROXSUITE_NLP_EIGEN_ALLOW_MALLOC(allowed)
+#define PROXSUITE_NLP_MALLOC_ALLOWED_SCOPE
+#define PROXSUITE_NLP_NOMALLOC_STATE_SCOPE
+#define PROXSUITE_NLP_NOMALLOC_BEGIN
+#define PROXSUITE_NLP_NOMALLOC_END
+#endif
 
 #ifdef __GNUC__
 #define PROXSUITE_NLP_INLINE inline __attribute__((always_inline))
@@ -93,8 +93,8 @@ struct finite_difference_wrapper<_Scalar, TOC1> : C1FunctionTpl<_Scalar> {
                             const FuncType &func, const Scalar fd_eps)
       : Base(space, func.nr()), space(space), func(func), fd_eps(fd_eps) {}
 
-  VectorXs operator()(const ConstVectorRef &x) const override {
-    return func(x);
+  void evaluate(const ConstVectorRef &x, VectorRef out) const override {
+    func.evaluate(x, out);
   }
 
   void computeJacobian(const ConstVectorRef &x, MatrixRef Jout) const override {
@@ -127,8 +127,8 @@ struct finite_difference_wrapper<_Scalar, TOC2> : C2FunctionTpl<_Scalar> {
                             const FuncType &func, const Scalar fd_eps)
       : Base(space, func.nr()), space(space), func(func), fd_eps(fd_eps) {}
 
-  VectorXs operator()(const ConstVectorRef &x) const override {
-    return func(x);
+  void evaluate(const ConstVectorRef &x, VectorRef out) const override {
+    func.evaluate(x, out);
   }
 
   void computeJacobian(const ConstVectorRef &x, MatrixRef Jout) const override {
@@ -21,6 +21,10 @@ template <typename Scalar> struct BoxConstraintTpl : ConstraintSetBase<Scalar> {
   BoxConstraintTpl(const ConstVectorRef lower, const ConstVectorRef upper)
       : Base(), lower_limit(lower), upper_limit(upper) {}
 
+  shared_ptr<Base> clone() const {
+    return std::make_shared<BoxConstraintTpl>(*this);
+  }
+
   decltype(auto) projection_impl(const ConstVectorRef &z) const {
     return z.cwiseMin(upper_limit).cwiseMax(lower_limit);
   }
@@ -38,6 +42,26 @@ template <typename Scalar> struct BoxConstraintTpl : ConstraintSetBase<Scalar> {
     out.array() =
         (z.array() > upper_limit.array()) || (z.array() < lower_limit.array());
   }
+
+  void applyProjectionJacobian(const ConstVectorRef &z, MatrixRef Jout) const {
+    for (Eigen::Index i = 0; i < z.size(); i++) {
+      if (isActive(z, i))
+        Jout.row(i).setZero();
+    }
+  }
+
+  void applyNormalConeProjectionJacobian(const ConstVectorRef &z,
+                                         MatrixRef Jout) const {
+    for (Eigen::Index i = 0; i < z.size(); i++) {
+      if (!isActive(z, i))
+        Jout.row(i).setZero();
+    }
+  }
+
+private:
+  bool isActive(const ConstVectorRef &z, Eigen::Index i) const {
+    return (z(i) > upper_limit(i)) || (z(i) < lower_limit(i));
+  }
 };
 
 } // namespace nlp
@@ -23,6 +23,10 @@ public:
 
   bool disableGaussNewton() const { return true; }
 
+  shared_ptr<Base> clone() const {
+    return std::make_shared<EqualityConstraint>(*this);
+  }
+
   inline void projection(const ConstVectorRef &, VectorRef zout) const {
     zout.setZero();
   }
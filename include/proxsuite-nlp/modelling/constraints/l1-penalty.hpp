@@ -23,6 +23,10 @@ struct NonsmoothPenaltyL1Tpl : ConstraintSetBase<_Scalar> {
   using ActiveType = typename Base::ActiveType;
   using Base::mu_;
 
+  shared_ptr<Base> clone() const {
+    return std::make_shared<NonsmoothPenaltyL1Tpl>(*this);
+  }
+
   Scalar evaluate(const ConstVectorRef &zproj) const {
     return zproj.template lpNorm<1>();
   }
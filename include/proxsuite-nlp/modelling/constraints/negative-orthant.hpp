@@ -23,6 +23,10 @@ struct NegativeOrthant : ConstraintSetBase<_Scalar> {
   using Base = ConstraintSetBase<Scalar>;
   using ActiveType = typename Base::ActiveType;
 
+  shared_ptr<Base> clone() const {
+    return std::make_shared<NegativeOrthant>(*this);
+  }
+
   void projection(const ConstVectorRef &z, VectorRef zout) const {
     zout = z.cwiseMin(static_cast<Scalar>(0.));
   }
@@ -36,6 +40,21 @@ struct NegativeOrthant : ConstraintSetBase<_Scalar> {
                         Eigen::Ref<ActiveType> out) const {
     out.array() = (z.array() > static_cast<Scalar>(0.));
   }
+
+  void applyProjectionJacobian(const ConstVectorRef &z, MatrixRef Jout) const {
+    for (Eigen::Index i = 0; i < z.size(); i++) {
+      if (z(i) > static_cast<Scalar>(0.))
+        Jout.row(i).setZero();
+    }
+  }
+
+  void applyNormalConeProjectionJacobian(const ConstVectorRef &z,
+                                         MatrixRef Jout) const {
+    for (Eigen::Index i = 0; i < z.size(); i++) {
+      if (z(i) <= static_cast<Scalar>(0.))
+        Jout.row(i).setZero();
+    }
+  }
 };
 
 } // namespace nlp
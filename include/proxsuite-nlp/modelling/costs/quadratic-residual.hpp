@@ -24,10 +24,30 @@ public:
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
   using RowMatrixXs = Eigen::Matrix<Scalar, -1, -1, Eigen::RowMajor>;
   using Base = CostFunctionBaseTpl<Scalar>;
+  using BaseData = typename Base::BaseData;
+  using Base::call;
   using Base::computeGradient;
   using Base::computeHessian;
   using FunctionPtr = shared_ptr<FunctionType>;
 
+  /// Buffers for the residual and its derivatives.
+  struct Data : BaseData {
+    VectorXs err;
+    VectorXs tmp_w_err;
+    MatrixXs Jres;
+    RowMatrixXs JtW;
+    MatrixXs H;
+    /// Data of the residual function.
+    shared_ptr<BaseData> residual_data;
+
+    explicit Data(const QuadraticResidualCostTpl &cost)
+        : err(VectorXs::Zero(cost.residual_->nr())), tmp_w_err(err),
+          Jres(MatrixXs::Zero(cost.residual_->nr(), cost.ndx())),
+          JtW(RowMatrixXs::Zero(cost.ndx(), cost.residual_->nr())),
+          H(MatrixXs::Zero(cost.ndx(), cost.ndx())),
+          residual_data(cost.residual_->createData()) {}
+  };
+
   /// Residual function \f$r(x)\f$ the composite cost is constructed over.
   FunctionPtr residual_;
   /// Weights \f$Q\f$
@@ -57,18 +77,40 @@ public:
             allocate_shared_eigen_aligned<Underlying>(args...), weights, slope,
             constant) {}
 
-  Scalar call(const ConstVectorRef &x) const;
+  shared_ptr<BaseData> createData() const {
+    return std::make_shared<Data>(*this);
+  }
+
+  Scalar call(const ConstVectorRef &x) const {
+    return call(x, &default_data_);
+  }
+
+  void computeGradient(const ConstVectorRef &x, VectorRef out) const {
+    computeGradient(x, &default_data_, out);
+  }
 
-  void computeGradient(const ConstVectorRef &x, VectorRef out) const;
+  void computeHessian(const ConstVectorRef &x, MatrixRef out) const {
+    computeHessian(x, &default_data_, out);
+  }
 
-  void computeHessian(const ConstVectorRef &x, MatrixRef out) const;
+  Scalar call(const ConstVectorRef &x, BaseData *data) const;
+
+  /// @remark Uses the residual value computed by call() with the same data.
+  void computeGradient(const ConstVectorRef &x, BaseData *data,
+                       VectorRef out) const;
+
+  /// @remark Uses the residual value computed by call() with the same data.
+  void computeHessian(const ConstVectorRef &x, BaseData *data,
+                      MatrixRef out) const;
 
 protected:
-  mutable VectorXs err;
-  mutable VectorXs tmp_w_err;
-  mutable MatrixXs Jres;
-  mutable RowMatrixXs JtW;
-  mutable MatrixXs H;
+  /// Data used by the evaluations without explicit data, which are therefore
+  /// not reentrant.
+  mutable Data default_data_;
+
+  Data &getData(BaseData *data) const {
+    return data ? static_cast<Data &>(*data) : default_data_;
+  }
 };
 
 } // namespace nlp
@@ -11,23 +11,19 @@ QuadraticResidualCostTpl<Scalar>::QuadraticResidualCostTpl(
     const ConstVectorRef &slope, const Scalar constant)
     : Base(residual->nx(), residual->ndx()), residual_(residual),
       weights_(weights), slope_(slope), constant_(constant),
-      gauss_newton_(true), err(residual_->nr()),
-      Jres(residual_->nr(), this->ndx()), JtW(this->ndx(), residual_->nr()),
-      H(this->ndx(), this->ndx()) {
-  Jres.setZero();
-  err.setZero();
-  tmp_w_err = err;
-  H.setZero();
-}
+      gauss_newton_(true), default_data_(*this) {}
 
 template <typename Scalar>
-Scalar QuadraticResidualCostTpl<Scalar>::call(const ConstVectorRef &x) const {
-  err = (*residual_)(x);
-
+Scalar QuadraticResidualCostTpl<Scalar>::call(const ConstVectorRef &x,
+                                              BaseData *data) const {
+  Data &d = getData(data);
   PROXSUITE_NLP_NOMALLOC_BEGIN;
 
-  tmp_w_err.noalias() = weights_ * err;
-  Scalar res = Scalar(0.5) * err.dot(tmp_w_err) + err.dot(slope_) + constant_;
+  residual_->evaluate(x, d.residual_data.get(), d.err);
+
+  d.tmp_w_err.noalias() = weights_ * d.err;
+  Scalar res =
+      Scalar(0.5) * d.err.dot(d.tmp_w_err) + d.err.dot(slope_) + constant_;
 
   PROXSUITE_NLP_NOMALLOC_END;
 
@@ -36,31 +32,37 @@ Scalar QuadraticResidualCostTpl<Scalar>::call(const ConstVectorRef &x) const {
 
 template <typename Scalar>
 void QuadraticResidualCostTpl<Scalar>::computeGradient(const ConstVectorRef &x,
+                                                       BaseData *data,
                                                        VectorRef out) const {
-  residual_->computeJacobian(x, Jres);
+  Data &d = getData(data);
+  residual_->computeJacobian(x, d.residual_data.get(), d.Jres);
 
-  JtW.noalias() = Jres.transpose() * weights_;
-  out.noalias() = JtW * err;
-  out.noalias() += Jres.transpose() * slope_;
+  // matrix-vector products only, which do not allocate
+  d.tmp_w_err.noalias() = weights_ * d.err;
+  d.tmp_w_err += slope_;
+  out.noalias() = d.Jres.transpose() * d.tmp_w_err;
 }
 
 template <typename Scalar>
 void QuadraticResidualCostTpl<Scalar>::computeHessian(const ConstVectorRef &x,
+                                                      BaseData *data,
                                                       MatrixRef out) const {
-  tmp_w_err.noalias() = weights_ * err;
-  tmp_w_err += slope_;
+  Data &d = getData(data);
+  d.tmp_w_err.noalias() = weights_ * d.err;
+  d.tmp_w_err += slope_;
 
   if (!gauss_newton_) {
-    residual_->vectorHessianProduct(x, tmp_w_err, H);
-    out = H;
+    residual_->vectorHessianProduct(x, d.tmp_w_err, d.residual_data.get(),
+                                    d.H);
+    out = d.H;
   } else {
     out.setZero();
   }
 
-  Jres.setZero();
-  residual_->computeJacobian(x, Jres);
-  JtW.noalias() = Jres.transpose() * weights_;
-  out.noalias() += JtW * Jres;
+  d.Jres.setZero();
+  residual_->computeJacobian(x, d.residual_data.get(), d.Jres);
+  d.JtW.noalias() = d.Jres.transpose() * weights_;
+  out.noalias() += d.JtW * d.Jres;
 }
 
 } // namespace nlp
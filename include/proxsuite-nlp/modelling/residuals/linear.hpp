@@ -15,6 +15,8 @@ template <typename _Scalar> struct LinearFunctionTpl : C2FunctionTpl<_Scalar> {
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
 
   using Base = C2FunctionTpl<Scalar>;
+  using BaseData = typename Base::BaseData;
+  using SparseMatrixXs = typename Base::SparseMatrixXs;
   using Base::computeJacobian;
 
   MatrixXs mat;
@@ -26,11 +28,26 @@ template <typename _Scalar> struct LinearFunctionTpl : C2FunctionTpl<_Scalar> {
   LinearFunctionTpl(const ConstMatrixRef &A)
       : LinearFunctionTpl(A, VectorXs::Zero(A.rows())) {}
 
-  VectorXs operator()(const ConstVectorRef &x) const { return mat * x + b; }
+  void evaluate(const ConstVectorRef &x, VectorRef out) const {
+    out = b;
+    out.noalias() += mat * x;
+  }
 
   void computeJacobian(const ConstVectorRef &, MatrixRef Jout) const {
     Jout = mat;
   }
+
+  void computeSparseJacobian(const ConstVectorRef &, BaseData *,
+                             SparseMatrixXs &Jout) const {
+    Jout = mat.sparseView();
+  }
+
+  void sparseVectorHessianProduct(const ConstVectorRef &,
+                                  const ConstVectorRef &, BaseData *,
+                                  SparseMatrixXs &Hout) const {
+    Hout.resize(this->ndx(), this->ndx());
+    Hout.setZero();
+  }
 };
 
 /** @brief    Linear function of difference vector on a manifold, of the form
@@ -22,11 +22,11 @@ struct RigidTransformationPointActionTpl : C2FunctionTpl<Scalar> {
   RigidTransformationPointActionTpl(const Eigen::Ref<const Vector3s> &point)
       : Base(7, 6, 3), space_(), point_(point), skew_point_(pin::skew(point)) {}
 
-  VectorXs operator()(const ConstVectorRef &x) const override {
+  void evaluate(const ConstVectorRef &x, VectorRef out) const override {
     QuatConstMap q(x.template tail<4>().data());
     SE3 M(q, x.template head<3>());
 
-    return M.actOnEigenObject(point_);
+    out = M.actOnEigenObject(point_);
   }
 
   void computeJacobian(const ConstVectorRef &x, MatrixRef Jout) const override {
@@ -39,8 +39,8 @@ public:
     }
   }
 
-  VectorXs operator()(const ConstVectorRef &x) const {
-    return space_->difference(target_, x);
+  void evaluate(const ConstVectorRef &x, VectorRef out) const {
+    space_->difference(target_, x, out);
   }
 
   void computeJacobian(const ConstVectorRef &x, MatrixRef Jout) const {
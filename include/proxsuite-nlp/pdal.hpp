@@ -36,7 +36,17 @@ public:
   void computeGradient(const std::vector<VectorRef> &lams,
                        Workspace &workspace) const;
 
+  /// @copybrief computeGradient(). This variant takes the product
+  /// @p jac_tr_lams_pdal of the transposed constraint Jacobian with the
+  /// primal-dual multipliers, e.g. from WorkspaceTpl::jac_tr_multipliers.
+  void computeGradient(const std::vector<VectorRef> &lams,
+                       const ConstVectorRef &jac_tr_lams_pdal,
+                       Workspace &workspace) const;
+
 private:
+  void computeDualGradient(const std::vector<VectorRef> &lams,
+                           Workspace &workspace) const;
+
   // fraction of mu to use in linesearch; reference to outer algorithm param
   const Scalar &beta_;
   const Problem &problem_;
@@ -21,8 +21,8 @@ Scalar ALMeritFunctionTpl<Scalar>::evaluate(const ConstVectorRef & /*x*/,
   for (std::size_t i = 0; i < workspace.numblocks; i++) {
     const ConstraintObject &cstr = problem_.getConstraint(i);
     Scalar mu = cstr.set_->mu();
-    VectorXs scv_tmp = pd_scv[i];
-    res += 2.0 * cstr.set_->computeMoreauEnvelope(pd_scv[i], scv_tmp);
+    res += 2.0 * cstr.set_->computeMoreauEnvelope(
+                     pd_scv[i], workspace.shift_cstr_pdal_proj[i]);
     res += mu * lams[i].squaredNorm() / 4.0;
   }
   return res;
@@ -34,6 +34,20 @@ void ALMeritFunctionTpl<Scalar>::computeGradient(
   workspace.merit_gradient = workspace.objective_gradient;
   workspace.merit_gradient.noalias() +=
       workspace.data_jacobians.transpose() * workspace.data_lams_pdal;
+  computeDualGradient(lams, workspace);
+}
+
+template <typename Scalar>
+void ALMeritFunctionTpl<Scalar>::computeGradient(
+    const std::vector<VectorRef> &lams, const ConstVectorRef &jac_tr_lams_pdal,
+    Workspace &workspace) const {
+  workspace.merit_gradient = workspace.objective_gradient + jac_tr_lams_pdal;
+  computeDualGradient(lams, workspace);
+}
+
+template <typename Scalar>
+void ALMeritFunctionTpl<Scalar>::computeDualGradient(
+    const std::vector<VectorRef> &lams, Workspace &workspace) const {
   workspace.merit_dual_gradient.setZero();
   for (std::size_t i = 0; i < workspace.numblocks; i++) {
     const ConstraintObject &cstr = problem_.getConstraint(i);
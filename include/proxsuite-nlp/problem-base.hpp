@@ -6,6 +6,9 @@
 #include "proxsuite-nlp/cost-function.hpp"
 #include "proxsuite-nlp/constraint-base.hpp"
 #include "proxsuite-nlp/modelling/constraints/equality-constraint.hpp"
+#include "proxsuite-nlp/threads.hpp"
+
+#include <typeinfo>
 
 namespace proxsuite {
 namespace nlp {
@@ -22,6 +25,7 @@ public:
   using CostType = CostFunctionBaseTpl<Scalar>;
   using Manifold = ManifoldAbstractTpl<Scalar>;
   using Workspace = WorkspaceTpl<Scalar>;
+  using BaseData = FunctionDataTpl<Scalar>;
 
   /// The working manifold \f$M\f$.
   shared_ptr<Manifold> manifold_;
@@ -40,6 +44,23 @@ public:
     reset_constraint_dim_vars();
   }
 
+  virtual ~ProblemTpl() = default;
+
+  /// @brief Copy of the problem, sharing its manifold and functions, with its
+  /// own copy of the constraint sets (see ConstraintSetBase::clone()), which
+  /// hold the penalty parameter of a solver. This is required by
+  /// ProxNLPSolverTpl::solveBatch() and BatchedSolverTpl.
+  /// @details Derived problems must override this, e.g. by copying
+  /// themselves and calling cloneConstraintSets().
+  virtual shared_ptr<ProblemTpl> clone() const {
+    if (typeid(*this) != typeid(ProblemTpl))
+      PROXSUITE_NLP_RUNTIME_ERROR("This problem type does not implement "
+                                  "clone().");
+    auto out = std::make_shared<ProblemTpl>(*this);
+    out->cloneConstraintSets();
+    return out;
+  }
+
   /// Get a pointer to the \f$i\f$-th constraint pointer
   const ConstraintObject &getConstraint(const std::size_t &i) const {
     return constraints_[i];
@@ -74,34 +95,143 @@ public:
 
   int getIndex(std::size_t i) const { return indices_[i]; }
 
+  /// @brief Set the number of threads used to evaluate the constraint
+  /// blocks.
+  /// @details The constraint functions must then be safe to call concurrently
+  /// (each block writes to its own segment of the workspace), and must not
+  /// throw.
+  void setNumThreads(const std::size_t num_threads) {
+    if (!omp::multithreading_enabled() && num_threads > 1)
+      PROXSUITE_NLP_RUNTIME_ERROR(
+          "Multithreading is not enabled. You should recompile ProxNLP with "
+          "the BUILD_WITH_OPENMP_SUPPORT flag.");
+    num_threads_ = std::max(num_threads, std::size_t(1));
+  }
+
+  std::size_t getNumThreads() const { return num_threads_; }
+
   void evaluate(const ConstVectorRef &x, Workspace &workspace) const {
-    workspace.objective_value = cost().call(x);
+    workspace.objective_value = cost().call(x, workspace.cost_data.get());
 
-    for (std::size_t i = 0; i < getNumConstraints(); i++) {
+    auto eval_cstr = [&](std::size_t i) {
       const ConstraintObject &cstr = constraints_[i];
-      workspace.cstr_values[i] = cstr.func()(x);
-    }
+      cstr.func().evaluate(x, workspace.cstr_datas[i].get(),
+                           workspace.cstr_values[i]);
+    };
+    omp::parallel_for(num_threads_, getNumConstraints(), eval_cstr);
   }
 
   void computeDerivatives(const ConstVectorRef &x, Workspace &workspace) const {
-    cost().computeGradient(x, workspace.objective_gradient);
+    cost().computeGradient(x, workspace.cost_data.get(),
+                           workspace.objective_gradient);
 
-    for (std::size_t i = 0; i < getNumConstraints(); i++) {
+    auto eval_cstr = [&](std::size_t i) {
       const ConstraintObject &cstr = constraints_[i];
-      cstr.func().computeJacobian(x, workspace.cstr_jacobians[i]);
-    }
+      if (workspace.sparse_kkt)
+        cstr.func().computeSparseJacobian(x, workspace.cstr_datas[i].get(),
+                                          workspace.cstr_sparse_jacobians[i]);
+      else
+        cstr.func().computeJacobian(x, workspace.cstr_datas[i].get(),
+                                    workspace.cstr_jacobians[i]);
+    };
+    omp::parallel_for(num_threads_, getNumConstraints(), eval_cstr);
+  }
+
+  /// @brief Evaluate the problem and its first-order derivatives at the same
+  /// point, through C1FunctionTpl::computeValueAndJacobian().
+  /// @details As for evaluate(), this may be called in a no-malloc region;
+  /// only the sparse Jacobians are allowed to allocate.
+  void computeValuesAndDerivatives(const ConstVectorRef &x,
+                                   Workspace &workspace) const {
+    workspace.objective_value = cost().call(x, workspace.cost_data.get());
+    cost().computeGradient(x, workspace.cost_data.get(),
+                           workspace.objective_gradient);
+
+    auto eval_cstr = [&](std::size_t i) {
+      const ConstraintObject &cstr = constraints_[i];
+      BaseData *data = workspace.cstr_datas[i].get();
+      if (workspace.sparse_kkt) {
+        cstr.func().evaluate(x, data, workspace.cstr_values[i]);
+        PROXSUITE_NLP_MALLOC_ALLOWED_SCOPE;
+        cstr.func().computeSparseJacobian(x, data,
+                                          workspace.cstr_sparse_jacobians[i]);
+        return;
+      }
+      cstr.func().computeValueAndJacobian(x, data, workspace.cstr_values[i],
+                                          workspace.cstr_jacobians[i]);
+    };
+    omp::parallel_for(num_threads_, getNumConstraints(), eval_cstr);
   }
 
   void computeHessians(const ConstVectorRef &x, Workspace &workspace,
                        bool evaluate_all_constraint_hessians = false) const {
-    cost().computeHessian(x, workspace.objective_hessian);
-    for (std::size_t i = 0; i < getNumConstraints(); i++) {
+    if (workspace.sparse_kkt) {
+      computeSparseHessians(x, workspace, evaluate_all_constraint_hessians);
+      return;
+    }
+    cost().computeHessian(x, workspace.cost_data.get(),
+                          workspace.objective_hessian);
+
+    if (workspace.accumulate_hessians) {
+      workspace.cstr_lagrangian_hessian.setZero();
+      lagrangianHessian(x, workspace.data_lams_pdal, workspace,
+                        workspace.cstr_lagrangian_hessian,
+                        evaluate_all_constraint_hessians);
+      return;
+    }
+
+    auto eval_cstr = [&](std::size_t i) {
       const ConstraintObject &cstr = getConstraint(i);
       bool use_vhp =
           !cstr.set_->disableGaussNewton() || evaluate_all_constraint_hessians;
       if (use_vhp)
         cstr.func().vectorHessianProduct(x, workspace.lams_pdal[i],
+                                         workspace.cstr_datas[i].get(),
                                          workspace.cstr_vector_hessian_prod[i]);
+    };
+    omp::parallel_for(num_threads_, getNumConstraints(), eval_cstr);
+  }
+
+  /// @brief Sparse storage version of computeHessians(), for the workspaces
+  /// allocated with WorkspaceTpl::SparseTag.
+  void computeSparseHessians(const ConstVectorRef &x, Workspace &workspace,
+                             bool evaluate_all_constraint_hessians) const {
+    cost().computeSparseHessian(x, workspace.cost_data.get(),
+                                workspace.objective_sparse_hessian);
+
+    auto eval_cstr = [&](std::size_t i) {
+      const ConstraintObject &cstr = getConstraint(i);
+      bool use_vhp =
+          !cstr.set_->disableGaussNewton() || evaluate_all_constraint_hessians;
+      if (use_vhp)
+        cstr.func().sparseVectorHessianProduct(
+            x, workspace.lams_pdal[i], workspace.cstr_datas[i].get(),
+            workspace.cstr_sparse_hessians[i]);
+    };
+    omp::parallel_for(num_threads_, getNumConstraints(), eval_cstr);
+  }
+
+  /// @brief Add the constraint terms of the Lagrangian Hessian,
+  /// \f$ \sum_i \nabla^2_x (\lambda_i^\top c_i)(x) \f$, to @p Hout.
+  /// @details This is called by computeHessians() when the workspace
+  /// accumulates the vector-Hessian products, and can be overridden to
+  /// provide a fused evaluation. Constraint blocks whose set disables the
+  /// Gauss-Newton approximation are skipped unless
+  /// @p evaluate_all_constraint_hessians is true. The default implementation
+  /// evaluates the blocks serially, through
+  /// WorkspaceTpl::tmp_vector_hessian_prod.
+  virtual void
+  lagrangianHessian(const ConstVectorRef &x, const ConstVectorRef &lams,
+                    Workspace &workspace, MatrixRef Hout,
+                    bool evaluate_all_constraint_hessians = false) const {
+    for (std::size_t i = 0; i < getNumConstraints(); i++) {
+      const ConstraintObject &cstr = getConstraint(i);
+      if (cstr.set_->disableGaussNewton() && !evaluate_all_constraint_hessians)
+        continue;
+      cstr.func().vectorHessianProduct(
+          x, lams.segment(getIndex(i), getConstraintDim(i)),
+          workspace.cstr_datas[i].get(), workspace.tmp_vector_hessian_prod);
+      Hout += workspace.tmp_vector_hessian_prod;
     }
   }
 
@@ -110,6 +240,14 @@ protected:
   int nc_total_;
   std::vector<int> ncs_;
   std::vector<int> indices_;
+  /// Number of threads for the evaluation of the constraint blocks.
+  std::size_t num_threads_ = 1;
+
+  /// Replace the constraint sets by copies, see clone().
+  void cloneConstraintSets() {
+    for (ConstraintObject &cstr : constraints_)
+      cstr.set_ = cstr.set_->clone();
+  }
 
   /// Set values of const data members for constraint dimensions
   void reset_constraint_dim_vars() {
@@ -27,11 +27,20 @@ enum class HessianApprox {
   EXACT,
   /// Gauss-Newton (or rather SCQP) approximation
   GAUSS_NEWTON,
+  /// Damped BFGS approximation of the Lagrangian Hessian, built from gradient
+  /// differences. No second-order derivatives are evaluated.
+  BFGS,
 };
 
 enum InertiaFlag { INERTIA_OK = 0, INERTIA_BAD = 1, INERTIA_HAS_ZEROS = 2 };
 
-enum KktSystem { KKT_CLASSIC, KKT_PRIMAL_DUAL };
+enum KktSystem {
+  KKT_CLASSIC,
+  KKT_PRIMAL_DUAL,
+  /// Classic system, with the dual step eliminated through the Schur
+  /// complement \f$ H + \mu^{-1} J^\top J \f$ of the diagonal dual block.
+  KKT_CONDENSED
+};
 
 /// Semi-smooth Newton-based solver for nonlinear optimization using a
 /// primal-dual method of multipliers. This solver works by approximately
@@ -69,6 +78,34 @@ public:
   Scalar kkt_tolerance_ = 1e-13;
   LDLTChoice ldlt_choice_;
   KktSystem kkt_system_ = KKT_CLASSIC;
+  /// Only factorize the rows of the KKT system for the active constraints:
+  /// the dual steps of the inactive constraints, which are decoupled from the
+  /// rest of the system, are computed in closed form. This applies to
+  /// KKT_CLASSIC and KKT_PRIMAL_DUAL, with the LDLTChoice::DENSE,
+  /// BUNCHKAUFMAN, EIGEN and PROXSUITE backends. Must be set before setup().
+  bool reduced_kkt_ = false;
+  /// Sum the constraint vector-Hessian products into a single Lagrangian
+  /// Hessian buffer (see ProblemTpl::lagrangianHessian()), so that their
+  /// memory does not grow with the number of constraint blocks. Must be set
+  /// before setup().
+  bool accumulate_hessians_ = false;
+  /// Hold the constraint Jacobians, the Hessians and the KKT matrix in sparse
+  /// storage, and assemble the KKT matrix directly in sparse form for the
+  /// LDLTChoice::SPARSE backend (see WorkspaceTpl::SparseTag). The functions
+  /// provide their sparse derivatives through
+  /// C1FunctionTpl::computeSparseJacobian(),
+  /// C2FunctionTpl::sparseVectorHessianProduct() and
+  /// CostFunctionBaseTpl::computeSparseHessian(). This applies to KKT_CLASSIC
+  /// and KKT_PRIMAL_DUAL with the Armijo linesearch and exact or Gauss-Newton
+  /// Hessians; the Hessian of the proximal term is taken as
+  /// \f$ \rho I \f$, which is exact on vector spaces. Must be set before
+  /// setup().
+  bool sparse_kkt_ = false;
+
+  /// Warm-start consecutive calls to solve(): keep the penalty and proximal
+  /// parameters, subproblem tolerances, last inertia-correcting regularization
+  /// and (if none are provided) the multipliers from the previous solve.
+  bool warm_start_ = false;
 
   //// Algorithm proximal parameters
 
@@ -82,6 +119,27 @@ private:
   Scalar rho_ = rho_init_;   //< Primal proximal penalty parameter.
   Scalar mu_ = mu_init_;     //< Penalty parameter.
   Scalar mu_inv_ = 1. / mu_; //< Inverse penalty parameter.
+  bool has_solved_ = false;  //< Whether there is a previous state to reuse.
+  /// Number of step sizes evaluated concurrently in the linesearch.
+  std::size_t ls_num_threads_ = 1;
+  /// Trial workspaces of the speculative linesearch, one per step size.
+  std::vector<unique_ptr<Workspace>> ls_workspaces_;
+  /// Number of threads of the KKT factorization.
+  std::size_t ldlt_num_threads_ = 1;
+  /// Number of threads of solveBatch().
+  std::size_t batch_num_threads_ = 0;
+  /// Worker solvers of solveBatch(), one per thread.
+  std::vector<unique_ptr<ProxNLPSolverTpl>> batch_solvers_;
+  /// Results of the instances of the last call to solveBatch().
+  std::vector<unique_ptr<Results>> batch_results_;
+
+  /// Create a worker solver for solveBatch(), with the same settings and a
+  /// copy of the problem with its own constraint sets.
+  unique_ptr<ProxNLPSolverTpl> createBatchWorker() const;
+
+  /// Throw if the settings are not supported by the sparse KKT path.
+  void checkSparseKktSettings() const;
+
 public:
   Scalar inner_tol_min = 1e-9; //< Lower safeguard for the subproblem tolerance.
   Scalar mu_upper_ = 1.;       //< Upper safeguard for the penalty parameter.
@@ -133,10 +191,91 @@ public:
   const Manifold &manifold() const { return *problem_->manifold_; }
 
   void setup() {
-    workspace_ = std::make_unique<Workspace>(*problem_, ldlt_choice_);
+    if (sparse_kkt_) {
+      checkSparseKktSettings();
+      workspace_ = std::make_unique<Workspace>(
+          *problem_, typename Workspace::SparseTag());
+    } else {
+      workspace_ = std::make_unique<Workspace>(
+          *problem_, ldlt_choice_, hess_approx == HessianApprox::BFGS,
+          accumulate_hessians_);
+    }
     results_ = std::make_unique<Results>(*problem_);
+    has_solved_ = false;
+    boost::apply_visitor(SetNumThreadsVisitor{ldlt_num_threads_},
+                         workspace_->ldlt_);
+    if (reduced_kkt_) {
+      switch (ldlt_choice_) {
+      case LDLTChoice::BLOCKSPARSE:
+      case LDLTChoice::SPARSE:
+      case LDLTChoice::BLOCKTRIDIAG:
+        PROXSUITE_NLP_RUNTIME_ERROR(
+            "The reduced KKT system requires a dense LDLT backend.");
+      default:
+        break;
+      }
+      workspace_->allocateReducedKkt();
+    }
+    ls_workspaces_.clear();
+    if (ls_num_threads_ > 1) {
+      for (std::size_t k = 0; k < ls_num_threads_; k++) {
+        ls_workspaces_.push_back(std::make_unique<Workspace>(
+            *problem_, typename Workspace::TrialTag()));
+        ls_workspaces_.back()->prox_data = prox_penalty.createData();
+      }
+    }
+    batch_solvers_.clear();
+    // the problem dimensions may have changed
+    batch_results_.clear();
+    for (std::size_t k = 0; k < batch_num_threads_; k++)
+      batch_solvers_.push_back(createBatchWorker());
+  }
+
+  /// @brief Evaluate a ladder of @p num_threads step sizes concurrently in the
+  /// Armijo linesearch (see SpeculativeArmijoLinesearch). This should be set
+  /// before calling setup().
+  /// @warning The problem functions are then evaluated concurrently from
+  /// several threads, each with its own workspace: they should keep their
+  /// buffers in their data (see BaseFunctionTpl::createData()) rather than in
+  /// the function itself.
+  void setLinesearchNumThreads(const std::size_t num_threads) {
+    if (!omp::multithreading_enabled() && num_threads > 1)
+      PROXSUITE_NLP_RUNTIME_ERROR(
+          "Multithreading is not enabled. You should recompile ProxNLP with "
+          "the BUILD_WITH_OPENMP_SUPPORT flag.");
+    ls_num_threads_ = std::max(num_threads, std::size_t(1));
   }
 
+  std::size_t getLinesearchNumThreads() const { return ls_num_threads_; }
+
+  /// @brief Use @p num_threads threads in the KKT factorization, for the
+  /// backends which support it (LDLTChoice::DENSE and
+  /// LDLTChoice::BLOCKSPARSE). This should be set before calling setup().
+  void setLdltNumThreads(const std::size_t num_threads) {
+    if (!omp::multithreading_enabled() && num_threads > 1)
+      PROXSUITE_NLP_RUNTIME_ERROR(
+          "Multithreading is not enabled. You should recompile ProxNLP with "
+          "the BUILD_WITH_OPENMP_SUPPORT flag.");
+    ldlt_num_threads_ = std::max(num_threads, std::size_t(1));
+  }
+
+  std::size_t getLdltNumThreads() const { return ldlt_num_threads_; }
+
+  /// @brief Solve the instances of solveBatch() over @p num_threads threads.
+  /// This should be set before calling setup(), which allocates one worker
+  /// solver (and its workspace) per thread. Zero disables solveBatch().
+  /// @warning The problem functions are then evaluated concurrently, see
+  /// setLinesearchNumThreads().
+  void setBatchNumThreads(const std::size_t num_threads) {
+    if (!omp::multithreading_enabled() && num_threads > 1)
+      PROXSUITE_NLP_RUNTIME_ERROR(
+          "Multithreading is not enabled. You should recompile ProxNLP with "
+          "the BUILD_WITH_OPENMP_SUPPORT flag.");
+    batch_num_threads_ = num_threads;
+  }
+
+  std::size_t getBatchNumThreads() const { return batch_num_threads_; }
+
   /**
    * @brief Solve the problem.
    *
@@ -155,17 +294,73 @@ public:
    * @copybrief solve().
    *
    * @param x0    Initial guess.
-   * @param lams0 Initial Lagrange multipliers given separately for each
-   * constraint.
+   * @param lams0 Initial Lagrange multipliers, stacked. If empty, the
+   * multipliers are set to zero, or kept from the previous solve if
+   * warm-starting.
    *
    */
   ConvergenceFlag solve(const ConstVectorRef &x0,
                         const ConstVectorRef &lams0 = VectorXs(0));
 
+  /**
+   * @brief Solve a batch of instances of the problem, which only differ by
+   * their initial guess, in parallel (see setBatchNumThreads()).
+   *
+   * @details The instances are dynamically scheduled over the worker solvers
+   * allocated by setup(). The workers share the problem functions, have their
+   * own copy of the problem and its constraint sets (see ProblemTpl::clone()),
+   * and the settings of this solver at the time of setup(), without its
+   * callbacks, without warm-starting or nested multithreading, and are
+   * always quiet.
+   *
+   * @param x0s    Initial guesses.
+   * @param lams0s Initial stacked Lagrange multipliers of each instance. If
+   * empty, the multipliers are set to zero.
+   * @returns The convergence flag of each instance, ConvergenceFlag::FAILED
+   * if its solve threw. Its results are given by getBatchResults().
+   */
+  std::vector<ConvergenceFlag>
+  solveBatch(const std::vector<VectorXs> &x0s,
+             const std::vector<VectorXs> &lams0s = {});
+
+  /// Results of instance @p i of the last call to solveBatch().
+  const Results &getBatchResults(const std::size_t i) const {
+    return *batch_results_.at(i);
+  }
+
   void innerLoop(Workspace &workspace, Results &results);
 
   void assembleKktMatrix(Workspace &workspace);
 
+  /// Assemble the lower triangular part of the KKT matrix into
+  /// WorkspaceTpl::kkt_sparse, from the sparse derivatives (see sparse_kkt_).
+  /// The diagonal is always stored, so that the regularization is applied in
+  /// place.
+  void assembleSparseKktMatrix(Workspace &workspace);
+
+  /// Gather the primal rows and the rows of the active constraints (see
+  /// ResultsTpl::active_set) of the KKT matrix into the reduced KKT matrix.
+  void assembleReducedKktMatrix(Workspace &workspace,
+                                const Results &results) const;
+
+  /// Add the primal Hessian blocks (cost, proximal term and constraint
+  /// vector-Hessian products) of the KKT system to @p hess.
+  void addLagrangianHessian(Workspace &workspace, MatrixRef hess) const;
+
+  /// Factorize the KKT matrix with regularization @p delta on the primal block,
+  /// and check its inertia. If the current factorization only differs by the
+  /// regularization, and the backend supports it, it is updated instead.
+  InertiaFlag factorizeKktMatrix(Workspace &workspace, const Scalar delta);
+
+  /// @brief Update the quasi-Newton approximation of the Lagrangian Hessian
+  /// using the last accepted step, if any.
+  /// @details This uses Powell's damped BFGS update, which keeps the
+  /// approximation positive definite. The gradient at the current iterate is
+  /// pulled back to the tangent space at the previous one through the Jacobian
+  /// of the integration operation.
+  void updateHessianApproximation(Workspace &workspace,
+                                  const Results &results) const;
+
   /// Iterative refinement of the KKT linear system.
   PROXSUITE_NLP_INLINE bool iterativeRefinement(Workspace &workspace) const;
 
@@ -212,7 +407,8 @@ public:
 
   /**
    * Evaluate the problem data, as well as the proximal/projection operators,
-   * and the first-order & primal-dual multiplier estimates.
+   * and the first-order & primal-dual multiplier estimates. This is all the
+   * merit function needs, e.g. in linesearch trials.
    *
    * @param inner_lams_data Inner (SQP) dual variables
    * @param workspace       Problem workspace.
@@ -220,6 +416,14 @@ public:
   void computeMultipliers(const ConstVectorRef &inner_lams_data,
                           Workspace &workspace) const;
 
+  /**
+   * Reapply the projection Jacobians to the multiplier estimates computed by
+   * computeMultipliers(), for the KKT right-hand side.
+   *
+   * @param workspace Problem workspace.
+   */
+  void computeReprojectedMultipliers(Workspace &workspace) const;
+
   /**
    * Evaluate the derivatives (cost gradient, Hessian, constraint Jacobians,
    * vector-Hessian products) of the problem data.
@@ -235,6 +439,11 @@ public:
   void computeProblemDerivatives(const ConstVectorRef &x, Workspace &workspace,
                                  boost::mpl::true_) const;
 
+  /// Compute the row scaling of the constraint Jacobians by the normal cone
+  /// projection (WorkspaceTpl::data_jac_proj_scale), from the shifted
+  /// constraints computed by computeMultipliers().
+  void computeJacobianProjection(Workspace &workspace) const;
+
   /**
    * Compute the primal residuals at the current primal-dual pair \f$(x,
    * \lambda^+)\f$, where the multipliers are chosen to be the predicted next
@@ -252,6 +461,12 @@ public:
    */
   void tryStep(Workspace &workspace, const Results &results, Scalar alpha);
 
+  /// @brief Evaluate the merit function (without the proximal term) at the
+  /// trial point of step size @p alpha, using the step stored in
+  /// @p workspace.
+  Scalar evaluateTrialMerit(Workspace &workspace, const Results &results,
+                            Scalar alpha);
+
   void invokeCallbacks(Workspace &workspace, Results &results) {
     for (auto cb : callbacks_) {
       cb->call(workspace, results);
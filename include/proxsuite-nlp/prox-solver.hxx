@@ -8,6 +8,8 @@
 #include <fmt/ostream.h>
 #include <fmt/color.h>
 
+#include <limits>
+
 namespace proxsuite {
 namespace nlp {
 template <typename Scalar>
@@ -60,8 +62,16 @@ ConvergenceFlag ProxNLPSolverTpl<Scalar>::solve(const ConstVectorRef &x0,
   auto &results = *results_;
   auto &workspace = *workspace_;
 
-  setPenalty(mu_init_);
-  setProxParameter(rho_init_);
+  const bool warm = warm_start_ && has_solved_;
+  if (warm) {
+    // reapply the retained penalty to the constraint sets
+    setPenalty(mu_);
+  } else {
+    setPenalty(mu_init_);
+    setProxParameter(rho_init_);
+    workspace.delta_last = 0.;
+    workspace.resetQuasiNewton();
+  }
 
   // init variables
   results.x_opt = x0;
@@ -69,11 +79,18 @@ ConvergenceFlag ProxNLPSolverTpl<Scalar>::solve(const ConstVectorRef &x0,
   if (lams0.size() == workspace.numdual) {
     results.data_lams_opt = lams0;
     workspace.data_lams_prev = lams0;
+  } else if (warm) {
+    workspace.data_lams_prev = results.data_lams_opt;
+  } else {
+    results.data_lams_opt.setZero();
+    workspace.data_lams_prev.setZero();
   }
 
-  updateToleranceFailure();
+  if (!warm)
+    updateToleranceFailure();
 
   results.converged = ConvergenceFlag::UNINIT;
+  results.timings.reset();
 
   std::size_t &i = results.num_iters;
   std::size_t &al_iter = results.al_iters;
@@ -104,26 +121,133 @@ ConvergenceFlag ProxNLPSolverTpl<Scalar>::solve(const ConstVectorRef &x0,
 
     al_iter++;
   }
+  has_solved_ = true;
 
-  if (results.converged == SUCCESS)
-    fmt::print(fmt::fg(fmt::color::dodger_blue),
-               "Solver successfully converged");
+  if (verbose != QUIET) {
+    if (results.converged == SUCCESS)
+      fmt::print(fmt::fg(fmt::color::dodger_blue),
+                 "Solver successfully converged");
 
-  switch (results.converged) {
-  case MAX_ITERS_REACHED:
-    fmt::print(fmt::fg(fmt::color::orange_red),
-               "Max number of iterations reached.");
-    break;
-  default:
-    break;
+    switch (results.converged) {
+    case MAX_ITERS_REACHED:
+      fmt::print(fmt::fg(fmt::color::orange_red),
+                 "Max number of iterations reached.");
+      break;
+    default:
+      break;
+    }
+    fmt::print("\n");
   }
-  fmt::print("\n");
 
   invokeCallbacks(workspace, results);
 
   return results.converged;
 }
 
+template <typename Scalar>
+std::vector<ConvergenceFlag>
+ProxNLPSolverTpl<Scalar>::solveBatch(const std::vector<VectorXs> &x0s,
+                                     const std::vector<VectorXs> &lams0s) {
+  if (batch_solvers_.empty()) {
+    PROXSUITE_NLP_RUNTIME_ERROR("No batch worker solver allocated. Call "
+                                "setBatchNumThreads() then setup() first.");
+  }
+  const std::size_t num_instances = x0s.size();
+  if (!lams0s.empty() && (lams0s.size() != num_instances)) {
+    PROXSUITE_NLP_RUNTIME_ERROR(
+        "Specified number of initial multipliers is not the same as the "
+        "number of initial guesses!");
+  }
+  // keep the results allocated from previous batches
+  batch_results_.resize(num_instances);
+  for (auto &res : batch_results_) {
+    if (res == nullptr)
+      res = std::make_unique<Results>(*problem_);
+  }
+
+  std::vector<ConvergenceFlag> flags(num_instances, ConvergenceFlag::UNINIT);
+  const std::size_t num_threads = batch_solvers_.size();
+  // the worker solves in place into the results of the instance; the swap is
+  // undone even if the solve throws
+  struct ResultsSwapGuard {
+    unique_ptr<Results> &a;
+    unique_ptr<Results> &b;
+    ResultsSwapGuard(unique_ptr<Results> &a, unique_ptr<Results> &b)
+        : a(a), b(b) {
+      std::swap(a, b);
+    }
+    ~ResultsSwapGuard() { std::swap(a, b); }
+  };
+  auto solve_instance = [&](std::size_t i) {
+    ProxNLPSolverTpl &worker = *batch_solvers_[omp::get_thread_id()];
+    // the solve may throw from inside a no-malloc region
+    PROXSUITE_NLP_NOMALLOC_STATE_SCOPE;
+    ResultsSwapGuard guard(worker.results_, batch_results_[i]);
+    try {
+      if (lams0s.empty())
+        flags[i] = worker.solve(x0s[i]);
+      else
+        flags[i] = worker.solve(x0s[i], lams0s[i]);
+    } catch (const std::exception &) {
+      // exceptions cannot leave the parallel region: flag the instance
+      flags[i] = ConvergenceFlag::FAILED;
+      worker.results_->converged = ConvergenceFlag::FAILED;
+    }
+  };
+  omp::parallel_for(num_threads, num_instances, solve_instance);
+  return flags;
+}
+
+template <typename Scalar>
+auto ProxNLPSolverTpl<Scalar>::createBatchWorker() const
+    -> unique_ptr<ProxNLPSolverTpl> {
+  auto prob = problem_->clone();
+  // the workers already run in parallel
+  prob->setNumThreads(1);
+  auto worker = std::make_unique<ProxNLPSolverTpl>(
+      prob, target_tol, mu_init_, rho_init_, QUIET, mu_lower_,
+      bcl_params.prim_alpha, bcl_params.prim_beta, bcl_params.dual_alpha,
+      bcl_params.dual_beta, ldlt_choice_, ls_options);
+  worker->hess_approx = hess_approx;
+  worker->ls_strat = ls_strat;
+  worker->mul_update_mode = mul_update_mode;
+  worker->max_refinement_steps_ = max_refinement_steps_;
+  worker->kkt_tolerance_ = kkt_tolerance_;
+  worker->kkt_system_ = kkt_system_;
+  worker->reduced_kkt_ = reduced_kkt_;
+  worker->accumulate_hessians_ = accumulate_hessians_;
+  worker->sparse_kkt_ = sparse_kkt_;
+  worker->inner_tol0 = inner_tol0;
+  worker->prim_tol0 = prim_tol0;
+  worker->inner_tol_min = inner_tol_min;
+  worker->mu_upper_ = mu_upper_;
+  worker->setDualPenalty(pdal_beta_);
+  worker->bcl_params = bcl_params;
+  worker->DELTA_INIT = DELTA_INIT;
+  worker->max_iters = max_iters;
+  worker->max_al_iters = max_al_iters;
+  // the workers run concurrently: their output would interleave
+  worker->verbose = QUIET;
+  worker->setup();
+  return worker;
+}
+
+template <typename Scalar>
+void ProxNLPSolverTpl<Scalar>::checkSparseKktSettings() const {
+  if (ldlt_choice_ != LDLTChoice::SPARSE)
+    PROXSUITE_NLP_RUNTIME_ERROR(
+        "The sparse KKT system requires the LDLTChoice::SPARSE backend.");
+  if (kkt_system_ == KKT_CONDENSED || reduced_kkt_)
+    PROXSUITE_NLP_RUNTIME_ERROR("The sparse KKT system does not support the "
+                                "condensed or reduced KKT systems.");
+  if (hess_approx == HessianApprox::BFGS)
+    PROXSUITE_NLP_RUNTIME_ERROR(
+        "The sparse KKT system does not support the BFGS approximation.");
+  if (ls_strat != LinesearchStrategy::ARMIJO)
+    PROXSUITE_NLP_RUNTIME_ERROR(
+        "The sparse KKT system requires the Armijo linesearch.");
+}
+
 InertiaFlag checkInertia(const int ndx, const int numc,
                          const Eigen::VectorXi &signature) {
   auto inertiaTuple = computeInertiaTuple(signature);
@@ -188,7 +312,13 @@ void ProxNLPSolverTpl<Scalar>::computeMultipliers(
                                   workspace.lams_pdal[i]);
   }
   workspace.data_lams_pdal *= mu_inv_ / pdal_beta_;
+  PROXSUITE_NLP_NOMALLOC_END;
+}
 
+template <typename Scalar>
+void ProxNLPSolverTpl<Scalar>::computeReprojectedMultipliers(
+    Workspace &workspace) const {
+  PROXSUITE_NLP_NOMALLOC_BEGIN;
   workspace.data_lams_plus_reproj = workspace.data_lams_plus;
   workspace.data_lams_pdal_reproj = workspace.data_lams_pdal;
   for (std::size_t i = 0; i < problem_->getNumConstraints(); i++) {
@@ -206,18 +336,26 @@ template <typename Scalar>
 void ProxNLPSolverTpl<Scalar>::computeProblemDerivatives(
     const ConstVectorRef &x, Workspace &workspace, boost::mpl::false_) const {
   problem_->computeDerivatives(x, workspace);
+  computeJacobianProjection(workspace);
+}
 
-  workspace.data_jacobians_proj = workspace.data_jacobians;
+template <typename Scalar>
+void ProxNLPSolverTpl<Scalar>::computeJacobianProjection(
+    Workspace &workspace) const {
+  // the normal cone projection acts row-wise: apply it to a column of ones
+  // to get the row scaling of the projected Jacobian
+  workspace.data_jac_proj_scale.setOnes();
   for (std::size_t i = 0; i < problem_->getNumConstraints(); i++) {
     const ConstraintSet &cstr_set = *problem_->getConstraint(i).set_;
     switch (kkt_system_) {
     case KKT_CLASSIC:
+    case KKT_CONDENSED:
       cstr_set.applyNormalConeProjectionJacobian(
-          workspace.shift_cstr_values[i], workspace.cstr_jacobians_proj[i]);
+          workspace.shift_cstr_values[i], workspace.cstr_jac_proj_scale[i]);
       break;
     case KKT_PRIMAL_DUAL:
       cstr_set.applyNormalConeProjectionJacobian(
-          workspace.shift_cstr_pdal[i], workspace.cstr_jacobians_proj[i]);
+          workspace.shift_cstr_pdal[i], workspace.cstr_jac_proj_scale[i]);
       break;
     }
   }
@@ -266,25 +404,96 @@ void ProxNLPSolverTpl<Scalar>::innerLoop(Workspace &workspace,
   const long ndual = ntot - ndx;
   const std::size_t num_c = problem_->getNumConstraints();
 
-  Scalar delta_last = 0.;
+  Scalar &delta_last = workspace.delta_last;
   Scalar delta = delta_last;
   Scalar phi_new = 0.;
 
   // lambda for evaluating the merit function
   auto phi_eval = [&](const Scalar alpha) {
-    tryStep(workspace, results, alpha);
-    problem_->evaluate(workspace.x_trial, workspace);
-    computeMultipliers(workspace.data_lams_trial, workspace);
-    return merit_fun.evaluate(workspace.x_trial, workspace.lams_trial,
-                              workspace) +
+    PROXSUITE_NLP_TIMED_SCOPE(results.timings.linesearch);
+    return evaluateTrialMerit(workspace, results, alpha) +
            prox_penalty.call(workspace.x_trial);
   };
 
+  // lambda evaluating the merit function at several step sizes, each in its
+  // own trial workspace
+  auto phi_batch_eval = [&](const std::vector<Scalar> &alphas,
+                            std::vector<Scalar> &values) {
+    PROXSUITE_NLP_TIMED_SCOPE(results.timings.linesearch);
+    const std::size_t num_alphas = alphas.size();
+    for (std::size_t k = 0; k < num_alphas; k++) {
+      ls_workspaces_[k]->pd_step = workspace.pd_step;
+      ls_workspaces_[k]->data_lams_prev = workspace.data_lams_prev;
+    }
+
+    // all the functions evaluated here use the data of the trial workspace
+    auto eval_trial = [&](std::size_t k) {
+      Workspace &ws_trial = *ls_workspaces_[k];
+      PROXSUITE_NLP_NOMALLOC_STATE_SCOPE;
+      try {
+        values[k] =
+            evaluateTrialMerit(ws_trial, results, alphas[k]) +
+            prox_penalty.call(ws_trial.x_trial, ws_trial.prox_data.get());
+      } catch (const std::runtime_error &) {
+        values[k] = std::numeric_limits<Scalar>::infinity();
+      }
+    };
+    omp::parallel_for(ls_num_threads_, num_alphas, eval_trial);
+  };
+
+  // lambda for evaluating the merit function and its derivative along the
+  // primal-dual step
+  auto phi_dphi_eval = [&](const Scalar alpha, Scalar &dphi) {
+    const Scalar phi = phi_eval(alpha);
+    PROXSUITE_NLP_TIMED_SCOPE(results.timings.derivatives);
+    computeProblemDerivatives(workspace.x_trial, workspace,
+                              boost::mpl::false_());
+    merit_fun.computeGradient(workspace.lams_trial, workspace);
+    if (rho_ > 0.) {
+      prox_penalty.computeGradient(workspace.x_trial, workspace.prox_grad);
+      workspace.merit_gradient += workspace.prox_grad;
+    }
+    // derivative of the retraction along the primal step
+    manifold().Jintegrate(results.x_opt, workspace.tmp_dx_scaled,
+                          workspace.tmp_jac_integrate, 1);
+    workspace.tmp_dx_scaled.noalias() =
+        workspace.tmp_jac_integrate * workspace.prim_step;
+    dphi = workspace.merit_gradient.dot(workspace.tmp_dx_scaled) +
+           workspace.merit_dual_gradient.dot(workspace.dual_step);
+    return phi;
+  };
+
+  // whether the problem data and multiplier estimates in the workspace are
+  // those of the current iterate (the accepted linesearch trial)
+  bool reuse_trial = false;
+  workspace.trial_evaluated = false;
+
   while (true) {
 
-    problem_->evaluate(results.x_opt, workspace);
-    computeMultipliers(results.data_lams_opt, workspace);
-    computeProblemDerivatives(results.x_opt, workspace, boost::mpl::true_());
+    if (reuse_trial) {
+      PROXSUITE_NLP_TIMED_SCOPE(results.timings.derivatives);
+      problem_->computeDerivatives(results.x_opt, workspace);
+    } else {
+      {
+        // values and Jacobians at the same point, in a single pass
+        PROXSUITE_NLP_TIMED_SCOPE(results.timings.evaluation);
+        PROXSUITE_NLP_NOMALLOC_BEGIN;
+        problem_->computeValuesAndDerivatives(results.x_opt, workspace);
+        PROXSUITE_NLP_NOMALLOC_END;
+      }
+      computeMultipliers(results.data_lams_opt, workspace);
+    }
+    workspace.trial_evaluated = false;
+    computeReprojectedMultipliers(workspace);
+    computeJacobianProjection(workspace);
+    {
+      PROXSUITE_NLP_TIMED_SCOPE(results.timings.hessians);
+      if (hess_approx == HessianApprox::BFGS)
+        updateHessianApproximation(workspace, results);
+      else
+        problem_->computeHessians(results.x_opt, workspace,
+                                  hess_approx == HessianApprox::EXACT);
+    }
 
     for (std::size_t i = 0; i < num_c; i++) {
       const ConstraintSet &cstr_set = *problem_->getConstraint(i).set_;
@@ -299,7 +508,9 @@ void ProxNLPSolverTpl<Scalar>::innerLoop(Workspace &workspace,
     if (rho_ > 0.) {
       results.merit += prox_penalty.call(results.x_opt);
       prox_penalty.computeGradient(results.x_opt, workspace.prox_grad);
-      prox_penalty.computeHessian(results.x_opt, workspace.prox_hess);
+      // the sparse KKT system adds rho to its diagonal instead
+      if (!workspace.sparse_kkt)
+        prox_penalty.computeHessian(results.x_opt, workspace.prox_hess);
     }
 
     PROXSUITE_NLP_NOMALLOC_BEGIN;
@@ -307,13 +518,36 @@ void ProxNLPSolverTpl<Scalar>::innerLoop(Workspace &workspace,
     workspace.kkt_rhs.setZero();
     workspace.kkt_rhs_corr.setZero();
 
+    // all products of the transposed Jacobian with multipliers, in one pass
+    workspace.multipliers_stack.col(Workspace::MULT_LAMS_OPT) =
+        results.data_lams_opt;
+    workspace.multipliers_stack.col(Workspace::MULT_LAMS_PDAL) =
+        workspace.data_lams_pdal;
+    workspace.multipliers_stack.col(Workspace::MULT_LAMS_REPROJ) =
+        kkt_system_ == KKT_PRIMAL_DUAL ? workspace.data_lams_pdal_reproj
+                                       : workspace.data_lams_plus_reproj;
+    workspace.multipliers_stack.col(Workspace::MULT_LAMS_OPT_PROJ) =
+        workspace.data_jac_proj_scale.cwiseProduct(results.data_lams_opt);
+    if (workspace.sparse_kkt) {
+      workspace.jac_tr_multipliers.setZero();
+      for (std::size_t i = 0; i < num_c; i++)
+        workspace.jac_tr_multipliers.noalias() +=
+            workspace.cstr_sparse_jacobians[i].transpose() *
+            workspace.multipliers_stack.middleRows(
+                problem_->getIndex(i), problem_->getConstraintDim(i));
+    } else {
+      workspace.jac_tr_multipliers.noalias() =
+          workspace.data_jacobians.transpose() * workspace.multipliers_stack;
+    }
+    const auto jac_tr_lams =
+        workspace.jac_tr_multipliers.col(Workspace::MULT_LAMS_OPT);
+
     // add jacobian-vector products to gradients
-    workspace.kkt_rhs.head(ndx) = workspace.objective_gradient;
-    workspace.kkt_rhs.head(ndx).noalias() +=
-        workspace.data_jacobians.transpose() * results.data_lams_opt;
+    workspace.kkt_rhs.head(ndx) = workspace.objective_gradient + jac_tr_lams;
 
     switch (kkt_system_) {
     case KKT_CLASSIC:
+    case KKT_CONDENSED:
       workspace.kkt_rhs.tail(ndual) =
           mu_ * (workspace.data_lams_plus - results.data_lams_opt);
       break;
@@ -323,7 +557,10 @@ void ProxNLPSolverTpl<Scalar>::innerLoop(Workspace &workspace,
       break;
     }
 
-    merit_fun.computeGradient(results.lams_opt, workspace);
+    merit_fun.computeGradient(
+        results.lams_opt,
+        workspace.jac_tr_multipliers.col(Workspace::MULT_LAMS_PDAL),
+        workspace);
     // add proximal penalty terms
     if (rho_ > 0.) {
       workspace.kkt_rhs.head(ndx) += workspace.prox_grad;
@@ -336,9 +573,7 @@ void ProxNLPSolverTpl<Scalar>::innerLoop(Workspace &workspace,
     computePrimalResiduals(workspace, results);
 
     // compute dual residual
-    workspace.dual_residual = workspace.objective_gradient;
-    workspace.dual_residual.noalias() +=
-        workspace.data_jacobians.transpose() * results.data_lams_opt;
+    workspace.dual_residual = workspace.objective_gradient + jac_tr_lams;
     results.dual_infeas = math::infty_norm(workspace.dual_residual);
     Scalar inner_crit = math::infty_norm(workspace.kkt_rhs);
     Scalar outer_crit = std::max(results.prim_infeas, results.dual_infeas);
@@ -346,33 +581,27 @@ void ProxNLPSolverTpl<Scalar>::innerLoop(Workspace &workspace,
     bool inner_cond = inner_crit <= inner_tol_;
     bool outer_cond = outer_crit <= target_tol; // allows early stopping
     if (inner_cond || outer_cond) {
+      PROXSUITE_NLP_NOMALLOC_END;
       return;
     }
 
     // If not optimal: compute the step
 
     // correct the rhs for the symmetric system
-    workspace.kkt_rhs_corr.head(ndx).noalias() -=
-        workspace.data_jacobians.transpose() * results.data_lams_opt;
-    workspace.kkt_rhs_corr.head(ndx).noalias() +=
-        workspace.data_jacobians_proj.transpose() * results.data_lams_opt;
-    switch (kkt_system_) {
-    case KKT_CLASSIC:
-      workspace.kkt_rhs_corr.head(ndx).noalias() +=
-          workspace.data_jacobians.transpose() *
-          workspace.data_lams_plus_reproj;
-      break;
-    case KKT_PRIMAL_DUAL:
-      workspace.kkt_rhs_corr.head(ndx).noalias() +=
-          workspace.data_jacobians.transpose() *
-          workspace.data_lams_pdal_reproj;
-      break;
-    }
+    workspace.kkt_rhs_corr.head(ndx) =
+        workspace.jac_tr_multipliers.col(Workspace::MULT_LAMS_REPROJ) -
+        jac_tr_lams +
+        workspace.jac_tr_multipliers.col(Workspace::MULT_LAMS_OPT_PROJ);
     // apply correction
     workspace.kkt_rhs += workspace.kkt_rhs_corr;
 
     // fill in KKT matrix
-    assembleKktMatrix(workspace);
+    {
+      PROXSUITE_NLP_TIMED_SCOPE(results.timings.kkt_assembly);
+      assembleKktMatrix(workspace);
+      if (reduced_kkt_ && kkt_system_ != KKT_CONDENSED)
+        assembleReducedKktMatrix(workspace, results);
+    }
 
     // choose regularisation level
 
@@ -380,18 +609,10 @@ void ProxNLPSolverTpl<Scalar>::innerLoop(Workspace &workspace,
     InertiaFlag is_inertia_correct = INERTIA_BAD;
 
     while (!(is_inertia_correct == INERTIA_OK) && delta <= DELTA_MAX) {
-      if (delta > 0.)
-        workspace.kkt_matrix.diagonal().head(ndx).array() += delta;
-
-      boost::apply_visitor(
-          [&](auto &&fac) { fac.compute(workspace.kkt_matrix); },
-          workspace.ldlt_);
-      boost::apply_visitor(ComputeSignatureVisitor{workspace.signature},
-                           workspace.ldlt_);
-      workspace.kkt_matrix.diagonal().head(ndx).array() -= delta;
-      is_inertia_correct =
-          checkInertia(manifold().ndx(), problem_->getTotalConstraintDim(),
-                       workspace.signature);
+      {
+        PROXSUITE_NLP_TIMED_SCOPE(results.timings.factorization);
+        is_inertia_correct = factorizeKktMatrix(workspace, delta);
+      }
 
       if (is_inertia_correct == INERTIA_OK) {
         delta_last = delta;
@@ -411,7 +632,10 @@ void ProxNLPSolverTpl<Scalar>::innerLoop(Workspace &workspace,
       }
     }
 
-    iterativeRefinement(workspace);
+    {
+      PROXSUITE_NLP_TIMED_SCOPE(results.timings.refinement);
+      iterativeRefinement(workspace);
+    }
 
     PROXSUITE_NLP_NOMALLOC_END;
     PROXSUITE_NLP_RAISE_IF_NAN_NAME(workspace.pd_step, "pd_step");
@@ -424,23 +648,57 @@ void ProxNLPSolverTpl<Scalar>::innerLoop(Workspace &workspace,
 
     Scalar phi0 = results.merit;
     Scalar dphi0 = workspace.dmerit_dir;
+
+    if (hess_approx == HessianApprox::BFGS) {
+      // keep the Lagrangian gradient at the current iterate for the secant
+      // update, before the linesearch overwrites the derivatives; the
+      // gradient difference buffer holds the part linear in the step size
+      workspace.qn_grad_prev = workspace.dual_residual;
+      workspace.qn_grad_diff.noalias() =
+          workspace.data_jacobians.transpose() * workspace.dual_step;
+    }
+
     switch (ls_strat) {
     case LinesearchStrategy::ARMIJO: {
+      if (ls_workspaces_.size() > 1) {
+        phi_new = SpeculativeArmijoLinesearch<Scalar>(ls_options,
+                                                      ls_workspaces_.size())
+                      .run(phi_batch_eval, results.merit, dphi0,
+                           workspace.alpha_opt);
+        break;
+      }
       phi_new = ArmijoLinesearch<Scalar>(ls_options)
                     .run(phi_eval, results.merit, dphi0, workspace.alpha_opt);
       break;
     }
+    case LinesearchStrategy::WOLFE: {
+      phi_new =
+          WolfeLinesearch<Scalar>(ls_options)
+              .run(phi_dphi_eval, results.merit, dphi0, workspace.alpha_opt);
+      break;
+    }
     default:
       PROXSUITE_NLP_RUNTIME_ERROR("Unrecognized linesearch alternative.\n");
       break;
     }
 
+    reuse_trial = workspace.trial_evaluated &&
+                  workspace.trial_alpha == workspace.alpha_opt;
     tryStep(workspace, results, workspace.alpha_opt);
 
+    if (hess_approx == HessianApprox::BFGS) {
+      // gradient with the new multipliers
+      workspace.qn_grad_prev += workspace.alpha_opt * workspace.qn_grad_diff;
+      workspace.qn_step = workspace.tmp_dx_scaled;
+      manifold().Jintegrate(results.x_opt, workspace.qn_step,
+                            workspace.tmp_jac_integrate, 1);
+      workspace.qn_has_step = true;
+    }
+
     PROXSUITE_NLP_RAISE_IF_NAN_NAME(workspace.alpha_opt, "alpha_opt");
     PROXSUITE_NLP_RAISE_IF_NAN_NAME(workspace.x_trial, "x_trial");
     PROXSUITE_NLP_RAISE_IF_NAN_NAME(workspace.data_lams_trial, "lams_trial");
-    results.x_opt = workspace.x_trial;
+    results.x_opt.swap(workspace.x_trial);
     results.data_lams_opt = workspace.data_lams_trial;
     results.merit = phi_new;
     PROXSUITE_NLP_RAISE_IF_NAN_NAME(results.merit, "merit");
@@ -474,48 +732,353 @@ template <typename Scalar>
 void ProxNLPSolverTpl<Scalar>::assembleKktMatrix(Workspace &workspace) {
   const long ndx = (long)manifold().ndx();
   const long ndual = workspace.numdual;
+  if (workspace.sparse_kkt) {
+    assembleSparseKktMatrix(workspace);
+    return;
+  }
+  if (kkt_system_ == KKT_CONDENSED) {
+    // only the lower triangular part is filled in, and used by the LLT
+    workspace.kkt_condensed.setZero();
+    addLagrangianHessian(workspace, workspace.kkt_condensed);
+    // rank update with the runs of rows sharing the same (nonzero) scaling;
+    // rows zeroed by the projection are skipped
+    const VectorXs &scale = workspace.data_jac_proj_scale;
+    long start = 0;
+    while (start < ndual) {
+      long end = start + 1;
+      while (end < ndual && scale(end) == scale(start))
+        end++;
+      const Scalar s = scale(start);
+      if (s != 0.)
+        workspace.kkt_condensed.template selfadjointView<Eigen::Lower>()
+            .rankUpdate(workspace.data_jacobians.middleRows(start, end - start)
+                            .transpose(),
+                        mu_inv_ * s * s);
+      start = end;
+    }
+    return;
+  }
+  workspace.ldlt_current = false;
   workspace.kkt_matrix.setZero();
-  workspace.kkt_matrix.topLeftCorner(ndx, ndx) = workspace.objective_hessian;
-  workspace.kkt_matrix.topRightCorner(ndx, ndual) =
-      workspace.data_jacobians_proj.transpose();
-  workspace.kkt_matrix.bottomLeftCorner(ndual, ndx) =
-      workspace.data_jacobians_proj;
+  addLagrangianHessian(workspace, workspace.kkt_matrix.topLeftCorner(ndx, ndx));
+  workspace.kkt_matrix.topRightCorner(ndx, ndual).noalias() =
+      workspace.data_jacobians.transpose() *
+      workspace.data_jac_proj_scale.asDiagonal();
+  workspace.kkt_matrix.bottomLeftCorner(ndual, ndx).noalias() =
+      workspace.data_jac_proj_scale.asDiagonal() * workspace.data_jacobians;
   auto lower_right_block = workspace.kkt_matrix.bottomRightCorner(ndual, ndual);
   lower_right_block.diagonal().setConstant(-mu_);
 
-  if (rho_ > 0.) {
-    workspace.kkt_matrix.topLeftCorner(ndx, ndx) += workspace.prox_hess;
+  if (kkt_system_ == KKT_PRIMAL_DUAL) {
+    // correct lower right corner in primal-dual case: average the diagonal
+    // with its normal cone projection
+    lower_right_block.diagonal().array() *=
+        0.5 * (1. + workspace.data_jac_proj_scale.array());
   }
+}
+
+template <typename Scalar>
+void ProxNLPSolverTpl<Scalar>::assembleSparseKktMatrix(Workspace &workspace) {
+  using Triplet = typename Workspace::Triplet;
+  using InnerIterator = typename Workspace::SparseMatrixXs::InnerIterator;
+  // the sparse storage is resized by the assembly
+  PROXSUITE_NLP_MALLOC_ALLOWED_SCOPE;
+  const long ndx = workspace.ndx;
+  const long ndual = workspace.numdual;
+  std::vector<Triplet> &triplets = workspace.kkt_triplets;
+  triplets.clear();
+  // lower triangular part of a primal Hessian block
+  auto add_hessian = [&](const typename Workspace::SparseMatrixXs &hess) {
+    for (long j = 0; j < hess.outerSize(); j++) {
+      for (InnerIterator it(hess, j); it; ++it) {
+        if (it.row() >= j)
+          triplets.emplace_back(it.row(), j, it.value());
+      }
+    }
+  };
+
+  // primal diagonal, with the proximal term
+  for (long j = 0; j < ndx; j++)
+    triplets.emplace_back(j, j, rho_);
+  add_hessian(workspace.objective_sparse_hessian);
   for (std::size_t i = 0; i < workspace.numblocks; i++) {
     const ConstraintSet &cstr_set = *problem_->getConstraint(i).set_;
     bool use_vhp =
         !cstr_set.disableGaussNewton() || (hess_approx == HessianApprox::EXACT);
-    if (use_vhp) {
-      workspace.kkt_matrix.topLeftCorner(ndx, ndx) +=
-          workspace.cstr_vector_hessian_prod[i];
+    if (use_vhp)
+      add_hessian(workspace.cstr_sparse_hessians[i]);
+  }
+
+  // projected Jacobians; the rows zeroed by the projection are kept as
+  // explicit zeros, so that the pattern does not depend on the active set
+  const VectorXs &scale = workspace.data_jac_proj_scale;
+  for (std::size_t i = 0; i < workspace.numblocks; i++) {
+    const long idx = problem_->getIndex(i);
+    const auto &jac = workspace.cstr_sparse_jacobians[i];
+    for (long j = 0; j < jac.outerSize(); j++) {
+      for (InnerIterator it(jac, j); it; ++it) {
+        const long row = idx + it.row();
+        triplets.emplace_back(ndx + row, j, scale(row) * it.value());
+      }
     }
+  }
+
+  for (long k = 0; k < ndual; k++) {
+    Scalar diag = -mu_;
+    if (kkt_system_ == KKT_PRIMAL_DUAL)
+      diag *= 0.5 * (1. + scale(k));
+    triplets.emplace_back(ndx + k, ndx + k, diag);
+  }
+  workspace.kkt_sparse.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+template <typename Scalar>
+void ProxNLPSolverTpl<Scalar>::assembleReducedKktMatrix(
+    Workspace &workspace, const Results &results) const {
+  const long ndx = workspace.ndx;
+  if (workspace.kkt_active.size() != workspace.numdual)
+    PROXSUITE_NLP_RUNTIME_ERROR(
+        "Reduced KKT buffers are not allocated: call setup() again.");
+  // same active set as the one used to project the Jacobians
+  for (std::size_t i = 0; i < workspace.numblocks; i++) {
+    const int idx = problem_->getIndex(i);
+    const int nr = problem_->getConstraintDim(i);
+    auto active = workspace.kkt_active.segment(idx, nr);
     if (kkt_system_ == KKT_PRIMAL_DUAL) {
-      // correct lower right corner in primal-dual case
-      int idx = problem_->getIndex(i);
-      int nr = problem_->getConstraintDim(i);
-      auto d_sub = lower_right_block.diagonal().segment(idx, nr);
-      VectorXs d_sub2(d_sub);
-      // apply normal cone jacobian op
-      cstr_set.applyNormalConeProjectionJacobian(workspace.shift_cstr_pdal[i],
-                                                 d_sub2);
-      d_sub = 0.5 * (d_sub + d_sub2);
+      const ConstraintSet &cstr_set = *problem_->getConstraint(i).set_;
+      cstr_set.computeActiveSet(workspace.shift_cstr_pdal[i], active);
+    } else {
+      active = results.active_set[i];
+    }
+  }
+
+  // inactive rows of the projected Jacobian are zero: the corresponding dual
+  // steps are decoupled from the rest of the system
+  Eigen::VectorXi &rows = workspace.kkt_reduced_idx;
+  long nred = ndx;
+  for (long j = 0; j < workspace.numdual; j++) {
+    if (workspace.kkt_active(j))
+      rows(nred++) = int(ndx + j);
+  }
+  workspace.kkt_reduced_size = nred;
+
+  const MatrixXs &kkt = workspace.kkt_matrix;
+  auto kkt_red = workspace.kkt_matrix_reduced.topLeftCorner(nred, nred);
+  kkt_red.topLeftCorner(ndx, ndx) = kkt.topLeftCorner(ndx, ndx);
+  for (long c = 0; c < nred; c++) {
+    for (long r = std::max(c, ndx); r < nred; r++) {
+      kkt_red(r, c) = kkt(rows(r), rows(c));
+      kkt_red(c, r) = kkt_red(r, c);
+    }
+  }
+}
+
+template <typename Scalar>
+void ProxNLPSolverTpl<Scalar>::addLagrangianHessian(Workspace &workspace,
+                                                    MatrixRef hess) const {
+  if (rho_ > 0.) {
+    hess += workspace.prox_hess;
+  }
+  if (hess_approx == HessianApprox::BFGS) {
+    // the approximation includes the constraint curvature
+    hess += workspace.qn_hessian;
+    return;
+  }
+  hess += workspace.objective_hessian;
+  if (workspace.accumulate_hessians) {
+    hess += workspace.cstr_lagrangian_hessian;
+    return;
+  }
+  for (std::size_t i = 0; i < workspace.numblocks; i++) {
+    const ConstraintSet &cstr_set = *problem_->getConstraint(i).set_;
+    bool use_vhp =
+        !cstr_set.disableGaussNewton() || (hess_approx == HessianApprox::EXACT);
+    if (use_vhp) {
+      hess += workspace.cstr_vector_hessian_prod[i];
     }
   }
 }
 
+template <typename Scalar>
+void ProxNLPSolverTpl<Scalar>::updateHessianApproximation(
+    Workspace &workspace, const Results &results) const {
+  if (!workspace.qn_has_step)
+    return;
+  workspace.qn_has_step = false;
+  const VectorXs &s = workspace.qn_step;
+  VectorXs &y = workspace.qn_grad_diff;
+  VectorXs &Bs = workspace.qn_hess_step;
+  MatrixXs &B = workspace.qn_hessian;
+
+  // Lagrangian gradient at the new iterate; the dual residual buffer is
+  // recomputed later in the iteration.
+  workspace.dual_residual = workspace.objective_gradient;
+  workspace.dual_residual.noalias() +=
+      workspace.data_jacobians.transpose() * results.data_lams_opt;
+  y.noalias() =
+      workspace.tmp_jac_integrate.transpose() * workspace.dual_residual;
+  y -= workspace.qn_grad_prev;
+
+  Scalar sy = s.dot(y);
+  if (!workspace.qn_scaled && sy > 0.) {
+    // scale the initial approximation to the curvature along the first step
+    B.setIdentity();
+    B *= y.squaredNorm() / sy;
+    workspace.qn_scaled = true;
+  }
+  Bs.noalias() = B * s;
+  const Scalar sBs = s.dot(Bs);
+  if (sBs <= std::numeric_limits<Scalar>::epsilon())
+    return;
+
+  // Powell damping: ensures s^T y >= 0.2 s^T B s
+  if (sy < 0.2 * sBs) {
+    const Scalar theta = 0.8 * sBs / (sBs - sy);
+    y = theta * y + (1. - theta) * Bs;
+    sy = s.dot(y);
+  }
+  B.noalias() -= (Bs / sBs) * Bs.transpose();
+  B.noalias() += (y / sy) * y.transpose();
+}
+
+template <typename Scalar>
+InertiaFlag ProxNLPSolverTpl<Scalar>::factorizeKktMatrix(Workspace &workspace,
+                                                         const Scalar delta) {
+  // some backends (e.g. Bunch-Kaufman) allocate scratch space
+  PROXSUITE_NLP_MALLOC_ALLOWED_SCOPE;
+  if (kkt_system_ == KKT_CONDENSED) {
+    // The KKT matrix has the correct inertia iff its Schur complement
+    // w.r.t. the negative-definite dual block is positive definite.
+    workspace.kkt_condensed.diagonal().array() += delta;
+    workspace.llt_condensed.compute(workspace.kkt_condensed);
+    workspace.kkt_condensed.diagonal().array() -= delta;
+    return workspace.llt_condensed.info() == Eigen::Success ? INERTIA_OK
+                                                            : INERTIA_BAD;
+  }
+  const long ndx = workspace.ndx;
+  const long nkkt =
+      reduced_kkt_ ? workspace.kkt_reduced_size : workspace.kkt_rhs.size();
+  MatrixRef kkt_matrix =
+      reduced_kkt_
+          ? MatrixRef(workspace.kkt_matrix_reduced.topLeftCorner(nkkt, nkkt))
+          : MatrixRef(workspace.kkt_matrix);
+  // during the inertia correction, only the regularization of the primal
+  // block changes: from its first retry on, the backend keeps the Schur
+  // complement of that block so that the next retries only update it
+  bool updated = false;
+  if (workspace.ldlt_current && !workspace.ldlt_updatable) {
+    boost::apply_visitor(SetUpdatableRowsVisitor{0, ndx}, workspace.ldlt_);
+    workspace.ldlt_updatable = true;
+  } else if (workspace.ldlt_current) {
+    updated = boost::apply_visitor(
+        UpdateDiagonalVisitor<Scalar>(delta - workspace.ldlt_delta),
+        workspace.ldlt_);
+  }
+  if (updated) {
+    workspace.num_ldlt_updates++;
+  } else if (workspace.sparse_kkt) {
+    auto &kkt_sparse = workspace.kkt_sparse;
+    for (long j = 0; j < ndx; j++)
+      kkt_sparse.coeffRef(j, j) += delta;
+    boost::get<linalg::SparseLDLT<Scalar>>(workspace.ldlt_).compute(kkt_sparse);
+    for (long j = 0; j < ndx; j++)
+      kkt_sparse.coeffRef(j, j) -= delta;
+  } else {
+    if (delta > 0.)
+      kkt_matrix.diagonal().head(ndx).array() += delta;
+    boost::apply_visitor([&](auto &&fac) { fac.compute(kkt_matrix); },
+                         workspace.ldlt_);
+    kkt_matrix.diagonal().head(ndx).array() -= delta;
+  }
+  workspace.ldlt_current = true;
+  workspace.ldlt_delta = delta;
+  boost::apply_visitor(ComputeSignatureVisitor{workspace.signature},
+                       workspace.ldlt_);
+  return checkInertia(int(ndx), int(nkkt - ndx), workspace.signature);
+}
+
 template <typename Scalar>
 bool ProxNLPSolverTpl<Scalar>::iterativeRefinement(Workspace &workspace) const {
+  if (kkt_system_ == KKT_CONDENSED) {
+    const long ndx = workspace.ndx;
+    const long ndual = workspace.numdual;
+    const auto &jac = workspace.data_jacobians;
+    const auto &scale = workspace.data_jac_proj_scale;
+    VectorXs &tmp_dual = workspace.tmp_dual;
+    const auto &llt = workspace.llt_condensed;
+    auto rhs_dual = workspace.kkt_rhs.tail(ndual);
+    auto err = workspace.kkt_err.head(ndx);
+    auto kkt_condensed =
+        workspace.kkt_condensed.template selfadjointView<Eigen::Lower>();
+    bool refined = false;
+
+    // eliminate the dual step:
+    // dl = (J dx + r_l) / mu, (H + J^T J / mu) dx = -(r_x + J^T r_l / mu)
+    workspace.kkt_rhs_condensed = workspace.kkt_rhs.head(ndx);
+    tmp_dual = mu_inv_ * scale.cwiseProduct(rhs_dual);
+    workspace.kkt_rhs_condensed.noalias() += jac.transpose() * tmp_dual;
+    workspace.prim_step = -workspace.kkt_rhs_condensed;
+    llt.solveInPlace(workspace.prim_step);
+    for (std::size_t n = 0; n < max_refinement_steps_; n++) {
+      err = -workspace.kkt_rhs_condensed;
+      err.noalias() -= kkt_condensed * workspace.prim_step;
+      if (math::infty_norm(err) < kkt_tolerance_) {
+        refined = true;
+        break;
+      }
+      llt.solveInPlace(err);
+      workspace.prim_step += err;
+    }
+    tmp_dual.noalias() = jac * workspace.prim_step;
+    workspace.dual_step = mu_inv_ * (rhs_dual + scale.cwiseProduct(tmp_dual));
+    return refined;
+  }
+  if (reduced_kkt_) {
+    const long nred = workspace.kkt_reduced_size;
+    const Eigen::VectorXi &rows = workspace.kkt_reduced_idx;
+    auto rhs = workspace.kkt_rhs_reduced.head(nred);
+    auto step = workspace.pd_step_reduced.head(nred);
+    auto err = workspace.kkt_err_reduced.head(nred);
+    auto kkt_red = workspace.kkt_matrix_reduced.topLeftCorner(nred, nred);
+    for (long i = 0; i < nred; i++)
+      rhs(i) = workspace.kkt_rhs(rows(i));
+
+    bool refined = false;
+    step = -rhs;
+    boost::apply_visitor([&](auto &&fac) { fac.solveInPlace(step); },
+                         workspace.ldlt_);
+    for (std::size_t n = 0; n < max_refinement_steps_; n++) {
+      err = -rhs;
+      err.noalias() -= kkt_red * step;
+      if (math::infty_norm(err) < kkt_tolerance_) {
+        refined = true;
+        break;
+      }
+      boost::apply_visitor([&](auto &&fac) { fac.solveInPlace(err); },
+                           workspace.ldlt_);
+      step += err;
+    }
+
+    // closed-form dual steps of the inactive constraints
+    const long ndx = workspace.ndx;
+    for (long j = ndx; j < workspace.kkt_rhs.size(); j++)
+      workspace.pd_step(j) =
+          -workspace.kkt_rhs(j) / workspace.kkt_matrix(j, j);
+    for (long i = 0; i < nred; i++)
+      workspace.pd_step(rows(i)) = step(i);
+    return refined;
+  }
   workspace.pd_step = -workspace.kkt_rhs;
   boost::apply_visitor([&](auto &&fac) { fac.solveInPlace(workspace.pd_step); },
                        workspace.ldlt_);
   for (std::size_t n = 0; n < max_refinement_steps_; n++) {
     workspace.kkt_err = -workspace.kkt_rhs;
-    workspace.kkt_err.noalias() -= workspace.kkt_matrix * workspace.pd_step;
+    if (workspace.sparse_kkt)
+      workspace.kkt_err.noalias() -=
+          workspace.kkt_sparse.template selfadjointView<Eigen::Lower>() *
+          workspace.pd_step;
+    else
+      workspace.kkt_err.noalias() -= workspace.kkt_matrix * workspace.pd_step;
     if (math::infty_norm(workspace.kkt_err) < kkt_tolerance_)
       return true;
     boost::apply_visitor(
@@ -575,5 +1138,19 @@ void ProxNLPSolverTpl<Scalar>::tryStep(Workspace &workspace,
       results.data_lams_opt + alpha * workspace.dual_step;
   PROXSUITE_NLP_NOMALLOC_END;
 }
+
+template <typename Scalar>
+Scalar ProxNLPSolverTpl<Scalar>::evaluateTrialMerit(Workspace &workspace,
+                                                    const Results &results,
+                                                    Scalar alpha) {
+  tryStep(workspace, results, alpha);
+  PROXSUITE_NLP_NOMALLOC_BEGIN;
+  problem_->evaluate(workspace.x_trial, workspace);
+  PROXSUITE_NLP_NOMALLOC_END;
+  computeMultipliers(workspace.data_lams_trial, workspace);
+  workspace.trial_alpha = alpha;
+  workspace.trial_evaluated = true;
+  return merit_fun.evaluate(workspace.x_trial, workspace.lams_trial, workspace);
+}
 } // namespace nlp
 } // namespace proxsuite
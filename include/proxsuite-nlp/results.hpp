@@ -3,11 +3,17 @@
 #pragma once
 
 #include "proxsuite-nlp/problem-base.hpp"
+#include "proxsuite-nlp/timings.hpp"
 
 namespace proxsuite {
 namespace nlp {
 
-enum ConvergenceFlag { UNINIT = -1, SUCCESS = 0, MAX_ITERS_REACHED = 1 };
+enum ConvergenceFlag {
+  UNINIT = -1,
+  SUCCESS = 0,
+  MAX_ITERS_REACHED = 1,
+  FAILED = 2 //< The solve threw an exception (see solveBatch()).
+};
 inline auto format_as(ConvergenceFlag fl) { return fmt::underlying(fl); }
 
 /**
@@ -43,6 +49,8 @@ template <typename _Scalar> struct ResultsTpl {
   std::size_t al_iters = 0;
   Scalar mu;
   Scalar rho;
+  /// Cumulative timings of the solver phases (with ENABLE_TIMINGS).
+  SolverTimings timings;
 
   ResultsTpl(const Problem &prob)
       : x_opt(prob.manifold_->neutral()),
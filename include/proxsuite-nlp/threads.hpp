@@ -0,0 +1,74 @@
+/// @file
+/// @brief Utilities for multithreaded evaluation of the problem functions.
+/// @copyright Copyright (C) 2024 LAAS-CNRS, INRIA
+#pragma once
+
+#include "proxsuite-nlp/macros.hpp"
+
+#include <cstddef>
+
+#ifdef PROXSUITE_NLP_MULTITHREADING
+#include <omp.h>
+
+#define PROXSUITE_NLP_PRAGMA(x) _Pragma(#x)
+/// @brief Run the following for loop over @p nthreads OpenMP threads.
+#define PROXSUITE_NLP_OMP_PARALLEL_FOR(nthreads)                               \
+  PROXSUITE_NLP_PRAGMA(omp parallel for num_threads(nthreads)                  \
+                           schedule(dynamic) if (nthreads > 1))
+#else
+#define PROXSUITE_NLP_OMP_PARALLEL_FOR(nthreads)
+#endif
+
+namespace proxsuite {
+namespace nlp {
+namespace omp {
+
+/// @brief Whether the library was built with OpenMP support.
+constexpr bool multithreading_enabled() {
+#ifdef PROXSUITE_NLP_MULTITHREADING
+  return true;
+#else
+  return false;
+#endif
+}
+
+/// @brief Number of threads available to parallel regions.
+inline std::size_t get_available_threads() {
+#ifdef PROXSUITE_NLP_MULTITHREADING
+  return std::size_t(omp_get_max_threads());
+#else
+  return 1;
+#endif
+}
+
+/// @brief Call @p f on each index in [0, @p n) over @p nthreads threads.
+/// @details No parallel region is entered with a single thread: even when
+/// serialized, entering one costs about a microsecond, which dominates the
+/// evaluations of small problems (e.g. in ProxNLPSolverTpl::solveBatch()).
+/// Allocations are not checked inside the parallel region, since Eigen's
+/// no-malloc flag is shared by all threads.
+template <typename Index, typename F>
+void parallel_for(const std::size_t nthreads, const Index n, const F &f) {
+  if (nthreads > 1) {
+    PROXSUITE_NLP_MALLOC_ALLOWED_SCOPE;
+    PROXSUITE_NLP_OMP_PARALLEL_FOR(nthreads)
+    for (Index i = 0; i < n; i++)
+      f(i);
+    return;
+  }
+  for (Index i = 0; i < n; i++)
+    f(i);
+}
+
+/// @brief Index of the calling thread within the current parallel region.
+inline std::size_t get_thread_id() {
+#ifdef PROXSUITE_NLP_MULTITHREADING
+  return std::size_t(omp_get_thread_num());
+#else
+  return 0;
+#endif
+}
+
+} // namespace omp
+} // namespace nlp
+} // namespace proxsuite
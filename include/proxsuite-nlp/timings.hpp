@@ -0,0 +1,108 @@
+/// @file
+/// @brief Lightweight instrumentation of the solver phases.
+/// @copyright Copyright (C) 2024 LAAS-CNRS, INRIA
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <fmt/ostream.h>
+
+#ifdef PROXSUITE_NLP_WITH_TIMINGS
+/// @brief Add the time spent in the enclosing scope to the TimerStat @p stat.
+#define PROXSUITE_NLP_TIMED_SCOPE(stat)                                        \
+  ::proxsuite::nlp::ScopedTimer _proxsuite_nlp_scoped_timer(stat)
+#else
+#define PROXSUITE_NLP_TIMED_SCOPE(stat)
+#endif
+
+namespace proxsuite {
+namespace nlp {
+
+/// @brief Cumulative wall-clock time (in seconds) and number of calls.
+struct TimerStat {
+  double total = 0.;
+  std::size_t count = 0;
+
+  double mean() const { return count > 0 ? total / double(count) : 0.; }
+  void reset() {
+    total = 0.;
+    count = 0;
+  }
+};
+
+/// @brief RAII timer adding the time elapsed during its lifetime to a
+/// TimerStat.
+class ScopedTimer {
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit ScopedTimer(TimerStat &stat) : stat_(stat), start_(clock::now()) {}
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  ~ScopedTimer() {
+    std::chrono::duration<double> elapsed = clock::now() - start_;
+    stat_.total += elapsed.count();
+    stat_.count++;
+  }
+
+private:
+  TimerStat &stat_;
+  clock::time_point start_;
+};
+
+/// @brief Timers for the phases of the solver inner loop. These are only
+/// filled in when the library is built with the ENABLE_TIMINGS option.
+struct SolverTimings {
+  /// Function evaluations at the current iterate, along with their
+  /// first-order derivatives (see ProblemTpl::computeValuesAndDerivatives()).
+  TimerStat evaluation;
+  /// Jacobian and gradient evaluations (when not fused with the function
+  /// evaluations).
+  TimerStat derivatives;
+  /// Hessian and vector-Hessian product evaluations.
+  TimerStat hessians;
+  /// Assembly of the KKT matrix.
+  TimerStat kkt_assembly;
+  /// KKT factorization, counting each inertia-correcting attempt.
+  TimerStat factorization;
+  /// Iterative refinement of the KKT system solution.
+  TimerStat refinement;
+  /// Merit function evaluations in the linesearch.
+  TimerStat linesearch;
+
+  void reset() {
+    evaluation.reset();
+    derivatives.reset();
+    hessians.reset();
+    kkt_assembly.reset();
+    factorization.reset();
+    refinement.reset();
+    linesearch.reset();
+  }
+
+  friend std::ostream &operator<<(std::ostream &oss,
+                                  const SolverTimings &self) {
+    auto print_stat = [&oss](const char *name, const TimerStat &stat) {
+      oss << fmt::format("\n  {:<14s} {:.3e} s  ({:d} calls)", name,
+                         stat.total, stat.count);
+    };
+    oss << "Timings {";
+    print_stat("evaluation:", self.evaluation);
+    print_stat("derivatives:", self.derivatives);
+    print_stat("hessians:", self.hessians);
+    print_stat("kkt_assembly:", self.kkt_assembly);
+    print_stat("factorization:", self.factorization);
+    print_stat("refinement:", self.refinement);
+    print_stat("linesearch:", self.linesearch);
+    oss << "\n}";
+    return oss;
+  }
+};
+
+} // namespace nlp
+} // namespace proxsuite
+
+template <>
+struct fmt::formatter<::proxsuite::nlp::SolverTimings>
+    : fmt::ostream_formatter {};
@@ -4,13 +4,168 @@
 
 #include "proxsuite-nlp/problem-base.hpp"
 #include "proxsuite-nlp/ldlt-allocator.hpp"
+#include "proxsuite-nlp/modelling/spaces/cartesian-product.hpp"
 
 namespace proxsuite {
 namespace nlp {
 
+/// @brief Block structure of the KKT matrix of problem @p prob.
+/// @details If the problem manifold is a CartesianProductTpl, the primal
+/// variable is split along its components. The blocks coupling a constraint
+/// to a component, or two components together, are zero unless some function
+/// declares a dependency on them (see
+/// BaseFunctionTpl::setComponentDependencies()).
+/// @param dense_hessian  Whether the Lagrangian Hessian should be assumed
+/// dense (e.g. for quasi-Newton approximations).
 template <typename Scalar>
-auto allocate_ldlt_from_problem(const ProblemTpl<Scalar> &prob,
-                                LDLTChoice choice) {
+linalg::SymbolicBlockMatrix
+create_problem_block_structure(const ProblemTpl<Scalar> &prob,
+                               bool dense_hessian = false) {
+  using linalg::BlockKind;
+  const std::size_t ncstr = prob.getNumConstraints();
+  std::vector<isize> nduals(ncstr);
+  for (std::size_t i = 0; i < ncstr; ++i)
+    nduals[i] = prob.getConstraintDim(i);
+
+  auto *product =
+      dynamic_cast<const CartesianProductTpl<Scalar> *>(&prob.manifold());
+  if (product == nullptr || product->numComponents() <= 1)
+    return create_default_block_structure({prob.ndx()}, nduals);
+
+  const std::size_t ncomp = product->numComponents();
+  std::vector<isize> nprims(ncomp);
+  for (std::size_t k = 0; k < ncomp; ++k)
+    nprims[k] = product->getComponent(k).ndx();
+
+  // component dependency mask of a function; all components by default
+  std::vector<char> mask(ncomp);
+  auto get_mask = [&](const BaseFunctionTpl<Scalar> &func) {
+    const std::vector<std::size_t> &deps = func.componentDependencies();
+    std::fill(mask.begin(), mask.end(), deps.empty());
+    for (std::size_t k : deps) {
+      if (k >= ncomp)
+        PROXSUITE_NLP_RUNTIME_ERROR(
+            fmt::format("Function depends on component {:d}, but the problem "
+                        "manifold only has {:d} components.",
+                        k, ncomp));
+      mask[k] = 1;
+    }
+  };
+
+  linalg::SymbolicBlockMatrix structure =
+      create_default_block_structure(nprims, nduals);
+  const auto nc = isize(ncomp);
+  for (isize a = 0; a < nc; ++a) {
+    for (isize b = 0; b < nc; ++b) {
+      structure(a, b) = (a == b || dense_hessian) ? BlockKind::Dense
+                                                  : BlockKind::Zero;
+    }
+  }
+  // couple the components appearing together in a Hessian
+  auto add_hessian_coupling = [&]() {
+    for (isize a = 0; a < nc; ++a) {
+      for (isize b = 0; b < nc; ++b) {
+        if (mask[std::size_t(a)] && mask[std::size_t(b)])
+          structure(a, b) = BlockKind::Dense;
+      }
+    }
+  };
+  get_mask(prob.cost());
+  add_hessian_coupling();
+
+  for (std::size_t i = 0; i < ncstr; ++i) {
+    get_mask(prob.getConstraint(i).func());
+    add_hessian_coupling();
+    const isize row = nc + isize(i);
+    for (isize a = 0; a < nc; ++a) {
+      const BlockKind kind =
+          mask[std::size_t(a)] ? BlockKind::Dense : BlockKind::Zero;
+      structure(row, a) = kind;
+      structure(a, row) = kind;
+    }
+  }
+  return structure;
+}
+
+/// @brief Stage-wise ordering of the KKT system of problem @p prob, for
+/// LDLTChoice::BLOCKTRIDIAG.
+/// @details Stage @p k gathers the @p k-th component of the CartesianProductTpl
+/// problem manifold, followed by the constraints whose last declared component
+/// dependency (see BaseFunctionTpl::setComponentDependencies()) is @p k.
+/// Constraints must depend on at most two consecutive components, and the
+/// cost Hessian is assumed not to couple non-consecutive components.
+/// @param[out] perm        Original index of each row of the ordered system.
+/// @param[out] stage_dims  Dimension of each stage.
+template <typename Scalar>
+void create_problem_stage_ordering(const ProblemTpl<Scalar> &prob,
+                                   std::vector<isize> &perm,
+                                   std::vector<isize> &stage_dims) {
+  const isize ndx = prob.ndx();
+  const std::size_t ncstr = prob.getNumConstraints();
+  auto *product =
+      dynamic_cast<const CartesianProductTpl<Scalar> *>(&prob.manifold());
+  const std::size_t nstages = product ? product->numComponents() : 1;
+
+  std::vector<isize> comp_start(nstages + 1, 0);
+  for (std::size_t k = 0; k < nstages; k++) {
+    comp_start[k + 1] =
+        comp_start[k] + (product ? product->getComponent(k).ndx() : ndx);
+  }
+  // stage of each constraint
+  std::vector<std::size_t> cstr_stage(ncstr, 0);
+  for (std::size_t i = 0; i < ncstr; i++) {
+    const auto &deps = prob.getConstraint(i).func().componentDependencies();
+    if (nstages == 1)
+      continue;
+    if (deps.empty())
+      PROXSUITE_NLP_RUNTIME_ERROR(fmt::format(
+          "Constraint {:d} does not declare its component dependencies.", i));
+    const std::size_t kmin = *std::min_element(deps.begin(), deps.end());
+    const std::size_t kmax = *std::max_element(deps.begin(), deps.end());
+    if (kmax >= nstages || kmax > kmin + 1)
+      PROXSUITE_NLP_RUNTIME_ERROR(fmt::format(
+          "Constraint {:d} should depend on at most two consecutive "
+          "components.",
+          i));
+    cstr_stage[i] = kmax;
+  }
+
+  perm.clear();
+  stage_dims.assign(nstages, 0);
+  for (std::size_t k = 0; k < nstages; k++) {
+    for (isize j = comp_start[k]; j < comp_start[k + 1]; j++)
+      perm.push_back(j);
+    stage_dims[k] += comp_start[k + 1] - comp_start[k];
+    for (std::size_t i = 0; i < ncstr; i++) {
+      if (cstr_stage[i] != k)
+        continue;
+      const isize start = ndx + prob.getIndex(i);
+      const isize nr = prob.getConstraintDim(i);
+      for (isize j = start; j < start + nr; j++)
+        perm.push_back(j);
+      stage_dims[k] += nr;
+    }
+  }
+}
+
+template <typename Scalar>
+LDLTVariant<Scalar> allocate_ldlt_from_problem(const ProblemTpl<Scalar> &prob,
+                                               LDLTChoice choice,
+                                               bool dense_hessian = false) {
+  if (choice == LDLTChoice::BLOCKSPARSE) {
+    const isize size = prob.ndx() + prob.getTotalConstraintDim();
+    return allocate_block_ldlt<Scalar>(
+        size, create_problem_block_structure(prob, dense_hessian));
+  }
+  if (choice == LDLTChoice::BLOCKTRIDIAG) {
+    if (dense_hessian)
+      PROXSUITE_NLP_RUNTIME_ERROR(
+          "The block-tridiagonal LDLT requires a stage-wise Hessian.");
+    std::vector<isize> perm;
+    std::vector<isize> stage_dims;
+    create_problem_stage_ordering(prob, perm, stage_dims);
+    return linalg::BlockTridiagLDLT<Scalar>(perm, stage_dims);
+  }
   std::vector<isize> nduals(prob.getNumConstraints());
   for (std::size_t i = 0; i < nduals.size(); ++i)
     nduals[i] = prob.getConstraintDim(i);
@@ -26,6 +181,18 @@ public:
 
   PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
   using Problem = ProblemTpl<Scalar>;
+  using FunctionData = FunctionDataTpl<Scalar>;
+  using SparseMatrixXs = Eigen::SparseMatrix<Scalar>;
+  using Triplet = Eigen::Triplet<Scalar>;
+
+  /// Columns of multipliers_stack.
+  enum MultiplierProduct {
+    MULT_LAMS_OPT = 0,
+    MULT_LAMS_PDAL,
+    MULT_LAMS_REPROJ,
+    MULT_LAMS_OPT_PROJ,
+    NUM_MULTIPLIER_PRODUCTS
+  };
 
   /// Newton iteration variables
 
@@ -33,6 +200,12 @@ public:
   long ndx;
   std::size_t numblocks; // number of constraint blocks
   long numdual;          // total constraint dim
+  /// Whether only the buffers of the merit function evaluations at trial
+  /// points are allocated (see TrialTag).
+  bool trial_only = false;
+  /// Whether the derivatives and the KKT matrix are held in sparse storage
+  /// (see SparseTag).
+  bool sparse_kkt = false;
 
   /// KKT iteration matrix.
   MatrixXs kkt_matrix;
@@ -48,10 +221,59 @@ public:
   VectorRef dual_step;
   /// Signature of the KKT matrix
   Eigen::VectorXi signature;
+  /// Last accepted inertia-correcting regularization.
+  Scalar delta_last = 0.;
+  /// Whether the factorization in ldlt_ is that of the current KKT matrix,
+  /// up to the regularization ldlt_delta.
+  bool ldlt_current = false;
+  /// Regularization of the primal block in the current factorization.
+  Scalar ldlt_delta = 0.;
+  /// Number of regularization changes applied by updating the factorization
+  /// instead of recomputing it (see UpdateDiagonalVisitor).
+  std::size_t num_ldlt_updates = 0;
+  /// Whether the primal rows of ldlt_ were set as updatable (see
+  /// SetUpdatableRowsVisitor), which is done at the first retry of the
+  /// inertia correction.
+  bool ldlt_updatable = false;
+
+  /// Scratch dual vector (condensed KKT system).
+  VectorXs tmp_dual;
+  /// Whether each dual row of the KKT system is active (reduced KKT system).
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> kkt_active;
+  /// Rows of the KKT system kept in the reduced system.
+  Eigen::VectorXi kkt_reduced_idx;
+  /// Size of the reduced KKT system.
+  long kkt_reduced_size = 0;
+  /// Reduced KKT matrix, in its top-left corner.
+  MatrixXs kkt_matrix_reduced;
+  /// Reduced KKT right-hand side, step and error (for refinement).
+  VectorXs kkt_rhs_reduced;
+  VectorXs pd_step_reduced;
+  VectorXs kkt_err_reduced;
+
+  /// Condensed KKT matrix (primal Schur complement), lower triangular part.
+  MatrixXs kkt_condensed;
+  /// Condensed KKT right-hand side.
+  VectorXs kkt_rhs_condensed;
+  /// Cholesky factorization of the condensed KKT matrix.
+  Eigen::LLT<MatrixXs> llt_condensed;
 
   /// LDLT storage
   LDLTVariant<Scalar> ldlt_;
 
+  //// Sparse KKT system (see SparseTag)
+
+  /// Lower triangular part of the KKT matrix.
+  SparseMatrixXs kkt_sparse;
+  /// Entries of the KKT matrix, summed by the assembly into kkt_sparse.
+  std::vector<Triplet> kkt_triplets;
+  /// Objective function Hessian.
+  SparseMatrixXs objective_sparse_hessian;
+  /// Jacobian of each constraint.
+  std::vector<SparseMatrixXs> cstr_sparse_jacobians;
+  /// Vector-Hessian product of each constraint.
+  std::vector<SparseMatrixXs> cstr_sparse_hessians;
+
   //// Data for proximal algorithm
 
   VectorXs x_prev;
@@ -63,6 +285,9 @@ public:
 
   VectorXs prox_grad;
   MatrixXs prox_hess;
+  /// Data of the proximal penalty, for concurrent evaluations (set by the
+  /// solver; the penalty uses its own buffers if null).
+  shared_ptr<FunctionData> prox_data;
 
   /// Residuals
 
@@ -84,12 +309,33 @@ public:
   /// Merit function gradient in the dual variables (if applicable)
   VectorXs merit_dual_gradient;
 
+  /// Data of the cost function (see BaseFunctionTpl::createData()), so that
+  /// workspaces sharing a problem can be used concurrently.
+  shared_ptr<FunctionData> cost_data;
+  /// Data of the constraint functions.
+  std::vector<shared_ptr<FunctionData>> cstr_datas;
+
   MatrixXs data_jacobians;
-  MatrixXs data_hessians;
-  MatrixXs data_jacobians_proj;
   std::vector<MatrixRef> cstr_jacobians;
+  /// Whether the constraint vector-Hessian products are summed into
+  /// cstr_lagrangian_hessian, instead of being stored per block in
+  /// data_hessians.
+  bool accumulate_hessians;
+  /// Stacked vector-Hessian products, of size \f$ (n_b n_{dx}, n_{dx}) \f$
+  /// (empty if accumulate_hessians is set).
+  MatrixXs data_hessians;
   std::vector<MatrixRef> cstr_vector_hessian_prod;
-  std::vector<MatrixRef> cstr_jacobians_proj;
+  /// Sum of the constraint vector-Hessian products (if accumulate_hessians is
+  /// set).
+  MatrixXs cstr_lagrangian_hessian;
+  /// Scratch buffer for a single vector-Hessian product (if
+  /// accumulate_hessians is set).
+  MatrixXs tmp_vector_hessian_prod;
+  /// Row scaling of the constraint Jacobians by the normal cone projection;
+  /// the projected Jacobian is \f$ \mathrm{diag}(s) J \f$ and is never
+  /// formed explicitly.
+  VectorXs data_jac_proj_scale;
+  std::vector<VectorRef> cstr_jac_proj_scale;
 
   VectorXs data_shift_cstr_values;
   VectorXs data_lams_plus;
@@ -97,6 +343,17 @@ public:
   VectorXs data_lams_pdal;
   VectorXs data_lams_pdal_reproj;
   VectorXs data_shift_cstr_pdal;
+  VectorXs data_shift_cstr_pdal_proj;
+
+  /// Multiplier vectors multiplied by the transposed constraint Jacobian in
+  /// each iteration, stacked column-wise: the current multipliers, the
+  /// primal-dual estimates, then the reprojected estimates and the current
+  /// multipliers scaled by data_jac_proj_scale used in the KKT right-hand
+  /// side correction.
+  MatrixXs multipliers_stack;
+  /// Fused product \f$ J^\top [\lambda_1 \cdots \lambda_k] \f$ with
+  /// multipliers_stack.
+  MatrixXs jac_tr_multipliers;
 
   /// First-order multipliers \f$\mathrm{proj}(\lambda_e + c / \mu)\f$
   std::vector<VectorRef> lams_plus;
@@ -108,31 +365,141 @@ public:
   std::vector<VectorRef> lams_pdal;
   std::vector<VectorRef> lams_pdal_reproj;
   std::vector<VectorRef> shift_cstr_pdal;
+  /// Buffer for the projections computed in the merit function
+  std::vector<VectorRef> shift_cstr_pdal_proj;
 
   std::vector<Scalar> ls_alphas;
   std::vector<Scalar> ls_values;
   /// Optimal linesearch \f$\alpha^\star\f$
   Scalar alpha_opt;
+  /// Step size of the last merit function evaluation at x_trial.
+  Scalar trial_alpha = 0.;
+  /// Whether the problem data and the multiplier estimates (excluding the
+  /// reprojected ones) held in the workspace are those of the trial point at
+  /// trial_alpha.
+  bool trial_evaluated = false;
   /// Merit function derivative in descent direction
   Scalar dmerit_dir = 0.;
 
   VectorXs tmp_dx_scaled;
-
-  WorkspaceTpl(const Problem &prob, LDLTChoice ldlt_choice = LDLTChoice::DENSE)
+  /// Jacobian of the integration operation w.r.t. the step.
+  MatrixXs tmp_jac_integrate;
+
+  //// Quasi-Newton (BFGS) approximation of the Lagrangian Hessian
+
+  /// Current approximation \f$B_k\f$.
+  MatrixXs qn_hessian;
+  /// Last accepted primal step \f$s_k\f$.
+  VectorXs qn_step;
+  /// Lagrangian gradient at the previous iterate (with the new multipliers).
+  VectorXs qn_grad_prev;
+  /// Lagrangian gradient difference \f$y_k\f$.
+  VectorXs qn_grad_diff;
+  /// Buffer for \f$B_k s_k\f$.
+  VectorXs qn_hess_step;
+  /// Whether a step is waiting to be used in an update.
+  bool qn_has_step = false;
+  /// Whether the initial approximation was scaled.
+  bool qn_scaled = false;
+
+  /// Tag of the constructor of trial workspaces.
+  struct TrialTag {};
+  /// Tag of the constructor of sparse workspaces.
+  struct SparseTag {};
+  /// Tag of the constructor of evaluation-only workspaces.
+  struct EvaluationTag {};
+
+  /// @param dense_hessian  See create_problem_block_structure().
+  /// @param accumulate_hessians  Sum the constraint vector-Hessian products
+  /// into a single \f$ n_{dx} \times n_{dx} \f$ matrix instead of storing
+  /// them per block.
+  WorkspaceTpl(const Problem &prob, LDLTChoice ldlt_choice = LDLTChoice::DENSE,
+               bool dense_hessian = false, bool accumulate_hessians = false)
       : nx(long(prob.nx())), ndx(long(prob.ndx())),
         numblocks(prob.getNumConstraints()),
         numdual(prob.getTotalConstraintDim()),
         kkt_matrix(ndx + numdual, ndx + numdual), kkt_rhs(ndx + numdual),
         kkt_rhs_corr(ndx + numdual), kkt_err(kkt_rhs), pd_step(ndx + numdual),
         prim_step(pd_step.head(ndx)), dual_step(pd_step.tail(numdual)),
-        signature(ndx + numdual),
-        ldlt_(allocate_ldlt_from_problem(prob, ldlt_choice)), x_prev(nx),
-        x_trial(nx), data_lams_prev(numdual), data_lams_trial(numdual),
+        signature(ndx + numdual), tmp_dual(numdual),
+        kkt_condensed(ndx, ndx),
+        kkt_rhs_condensed(ndx), llt_condensed(ndx),
+        ldlt_(allocate_ldlt_from_problem(prob, ldlt_choice, dense_hessian)),
+        x_prev(nx), x_trial(nx), data_lams_prev(numdual),
+        data_lams_trial(numdual),
         prox_grad(ndx), prox_hess(ndx, ndx), dual_residual(ndx),
         data_cstr_values(numdual), objective_gradient(ndx),
         objective_hessian(ndx, ndx), merit_gradient(ndx),
         merit_dual_gradient(numdual), data_jacobians(numdual, ndx),
-        data_hessians((long)numblocks * ndx, ndx), data_lams_plus(numdual),
+        accumulate_hessians(accumulate_hessians),
+        data_hessians(accumulate_hessians ? 0 : (long)numblocks * ndx, ndx),
+        data_lams_plus(numdual),
+        data_lams_plus_reproj(numdual), data_lams_pdal(numdual),
+        tmp_dx_scaled(ndx), tmp_jac_integrate(ndx, ndx), qn_hessian(ndx, ndx),
+        qn_step(ndx), qn_grad_prev(ndx), qn_grad_diff(ndx),
+        qn_hess_step(ndx) {
+    init(prob);
+  }
+
+  /// @brief Allocate a workspace for the merit function evaluations at trial
+  /// points only (see ProxNLPSolverTpl::evaluateTrialMerit()), e.g. for the
+  /// speculative linesearch. The KKT system, the derivatives and the
+  /// quasi-Newton approximation are left empty.
+  WorkspaceTpl(const Problem &prob, TrialTag)
+      : nx(long(prob.nx())), ndx(long(prob.ndx())),
+        numblocks(prob.getNumConstraints()),
+        numdual(prob.getTotalConstraintDim()), trial_only(true),
+        pd_step(ndx + numdual), prim_step(pd_step.head(ndx)),
+        dual_step(pd_step.tail(numdual)), x_prev(nx), x_trial(nx),
+        data_lams_prev(numdual), data_lams_trial(numdual),
+        data_cstr_values(numdual), accumulate_hessians(false),
+        tmp_dx_scaled(ndx) {
+    init(prob);
+  }
+
+  /// @brief Allocate a workspace for the sparse KKT path of the solver (see
+  /// ProxNLPSolverTpl::sparse_kkt_), factorized by LDLTChoice::SPARSE. The
+  /// constraint Jacobians and the Hessians are held in sparse storage (see
+  /// C1FunctionTpl::computeSparseJacobian()), and the KKT matrix is assembled
+  /// directly into kkt_sparse: the dense KKT, condensed KKT, derivative and
+  /// quasi-Newton buffers are left empty.
+  WorkspaceTpl(const Problem &prob, SparseTag)
+      : nx(long(prob.nx())), ndx(long(prob.ndx())),
+        numblocks(prob.getNumConstraints()),
+        numdual(prob.getTotalConstraintDim()), sparse_kkt(true),
+        kkt_rhs(ndx + numdual), kkt_rhs_corr(ndx + numdual), kkt_err(kkt_rhs),
+        pd_step(ndx + numdual), prim_step(pd_step.head(ndx)),
+        dual_step(pd_step.tail(numdual)), signature(ndx + numdual),
+        tmp_dual(numdual),
+        ldlt_(linalg::SparseLDLT<Scalar>(ndx + numdual)),
+        kkt_sparse(ndx + numdual, ndx + numdual),
+        objective_sparse_hessian(ndx, ndx), x_prev(nx), x_trial(nx),
+        data_lams_prev(numdual), data_lams_trial(numdual), prox_grad(ndx),
+        dual_residual(ndx), data_cstr_values(numdual),
+        objective_gradient(ndx), merit_gradient(ndx),
+        merit_dual_gradient(numdual), accumulate_hessians(false),
+        data_lams_plus(numdual), data_lams_plus_reproj(numdual),
+        data_lams_pdal(numdual), tmp_dx_scaled(ndx) {
+    init(prob);
+  }
+
+  /// @brief Allocate a workspace for the evaluations of the problem, its
+  /// derivatives and the merit function only, e.g. for the lanes of
+  /// BatchedSolverTpl which assemble their own KKT systems. The constraint
+  /// vector-Hessian products are accumulated (see accumulate_hessians); the
+  /// KKT systems, their factorization and the quasi-Newton approximation are
+  /// left empty.
+  WorkspaceTpl(const Problem &prob, EvaluationTag)
+      : nx(long(prob.nx())), ndx(long(prob.ndx())),
+        numblocks(prob.getNumConstraints()),
+        numdual(prob.getTotalConstraintDim()), pd_step(ndx + numdual),
+        prim_step(pd_step.head(ndx)), dual_step(pd_step.tail(numdual)),
+        x_prev(nx), x_trial(nx), data_lams_prev(numdual),
+        data_lams_trial(numdual), prox_grad(ndx), prox_hess(ndx, ndx),
+        data_cstr_values(numdual), objective_gradient(ndx),
+        objective_hessian(ndx, ndx), merit_gradient(ndx),
+        merit_dual_gradient(numdual), data_jacobians(numdual, ndx),
+        accumulate_hessians(true), data_lams_plus(numdual),
         data_lams_plus_reproj(numdual), data_lams_pdal(numdual),
         tmp_dx_scaled(ndx) {
     init(prob);
@@ -144,6 +511,9 @@ public:
     kkt_rhs_corr.setZero();
     pd_step.setZero();
     signature.setZero();
+    tmp_dual.setZero();
+    kkt_condensed.setZero();
+    kkt_rhs_condensed.setZero();
 
     x_prev.setZero();
     x_trial.setZero();
@@ -161,6 +531,10 @@ public:
     merit_gradient.setZero();
     merit_dual_gradient.setZero();
     data_jacobians.setZero();
+    if (!trial_only) {
+      multipliers_stack.setZero(numdual, NUM_MULTIPLIER_PRODUCTS);
+      jac_tr_multipliers.setZero(ndx, NUM_MULTIPLIER_PRODUCTS);
+    }
     data_hessians.setZero();
 
     helpers::allocateMultipliersOrResiduals(prob, data_shift_cstr_values,
@@ -173,25 +547,66 @@ public:
                                             lams_pdal_reproj);
     helpers::allocateMultipliersOrResiduals(prob, data_shift_cstr_pdal,
                                             shift_cstr_pdal);
+    helpers::allocateMultipliersOrResiduals(prob, data_shift_cstr_pdal_proj,
+                                            shift_cstr_pdal_proj);
+    helpers::allocateMultipliersOrResiduals(prob, data_jac_proj_scale,
+                                            cstr_jac_proj_scale);
     tmp_dx_scaled.setZero();
+    tmp_jac_integrate.setZero();
+    resetQuasiNewton();
 
+    cost_data = prob.cost().createData();
+    cstr_datas.reserve(numblocks);
     cstr_jacobians.reserve(numblocks);
-    cstr_vector_hessian_prod.reserve(numblocks);
-
-    data_jacobians_proj = data_jacobians;
+    if (accumulate_hessians) {
+      cstr_lagrangian_hessian.setZero(ndx, ndx);
+      tmp_vector_hessian_prod.setZero(ndx, ndx);
+    } else if (!trial_only) {
+      cstr_vector_hessian_prod.reserve(numblocks);
+    }
 
     int cursor = 0;
     int nr = 0;
     for (std::size_t i = 0; i < numblocks; i++) {
       cursor = prob.getIndex(i);
       nr = prob.getConstraintDim(i);
+      cstr_datas.push_back(prob.getConstraint(i).func().createData());
+      if (trial_only)
+        continue;
+      if (sparse_kkt) {
+        cstr_sparse_jacobians.emplace_back(nr, ndx);
+        cstr_sparse_hessians.emplace_back(ndx, ndx);
+        continue;
+      }
       cstr_jacobians.emplace_back(data_jacobians.middleRows(cursor, nr));
-      cstr_jacobians_proj.emplace_back(
-          data_jacobians_proj.middleRows(cursor, nr));
-      cstr_vector_hessian_prod.emplace_back(
-          data_hessians.middleRows((int)i * ndx, ndx));
+      if (!accumulate_hessians)
+        cstr_vector_hessian_prod.emplace_back(
+            data_hessians.middleRows((int)i * ndx, ndx));
     }
   }
+
+  /// Allocate the buffers of the reduced KKT system.
+  void allocateReducedKkt() {
+    const long ntot = ndx + numdual;
+    kkt_active.setConstant(numdual, true);
+    kkt_reduced_idx.setLinSpaced(int(ntot), 0, int(ntot) - 1);
+    kkt_reduced_size = ntot;
+    kkt_matrix_reduced.setZero(ntot, ntot);
+    kkt_rhs_reduced.setZero(ntot);
+    pd_step_reduced.setZero(ntot);
+    kkt_err_reduced.setZero(ntot);
+  }
+
+  /// Reset the quasi-Newton Hessian approximation to the identity.
+  void resetQuasiNewton() {
+    qn_hessian.setIdentity();
+    qn_step.setZero();
+    qn_grad_prev.setZero();
+    qn_grad_diff.setZero();
+    qn_hess_step.setZero();
+    qn_has_step = false;
+    qn_scaled = false;
+  }
 };
 
 } // namespace nlp
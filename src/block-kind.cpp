@@ -4,6 +4,7 @@
 /// @copyright Copyright (C) 2022 LAAS-CNRS, INRIA
 #include "proxsuite-nlp/linalg/block-kind.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 namespace proxsuite {
@@ -103,6 +104,90 @@ Eigen::ComputationInfo SymbolicBlockMatrix::brute_force_best_permutation(
   return Eigen::Success;
 }
 
+Eigen::ComputationInfo SymbolicBlockMatrix::greedy_fill_reducing_permutation(
+    SymbolicBlockMatrix const &in, isize *best_perm, isize *iwork) {
+  const isize n = in.nsegments();
+  const isize *lens = in.segment_lens;
+
+  // adjacency of the (symmetrized) block graph
+  std::vector<char> adj(usize(n * n), 0);
+  std::vector<char> eliminated(usize(n), 0);
+  // whether the diagonal block is still diagonal (no update received yet)
+  std::vector<char> diag(usize(n), 0);
+  auto edge = [&](isize i, isize j) -> char & { return adj[usize(i + j * n)]; };
+  for (isize i = 0; i < n; ++i) {
+    diag[usize(i)] = in(i, i) == Diag;
+    for (isize j = 0; j < n; ++j) {
+      if (i != j && (in(i, j) != Zero || in(j, i) != Zero))
+        edge(i, j) = 1;
+    }
+  }
+
+  for (isize k = 0; k < n; ++k) {
+    isize best = -1;
+    isize best_fill = 0;
+    isize best_deg = 0;
+    for (isize v = 0; v < n; ++v) {
+      if (eliminated[usize(v)])
+        continue;
+      isize fill = 0;
+      isize deg = 0;
+      for (isize a = 0; a < n; ++a) {
+        if (eliminated[usize(a)] || !edge(v, a))
+          continue;
+        deg += lens[a];
+        if (diag[usize(a)])
+          fill += (lens[a] * (lens[a] - 1)) / 2;
+        for (isize b = a + 1; b < n; ++b) {
+          if (!eliminated[usize(b)] && edge(v, b) && !edge(a, b))
+            fill += lens[a] * lens[b];
+        }
+      }
+      if (best < 0 || fill < best_fill ||
+          (fill == best_fill && deg < best_deg)) {
+        best = v;
+        best_fill = fill;
+        best_deg = deg;
+      }
+    }
+    iwork[k] = best;
+    eliminated[usize(best)] = 1;
+    // neighbours of the eliminated block form a clique
+    for (isize a = 0; a < n; ++a) {
+      if (eliminated[usize(a)] || !edge(best, a))
+        continue;
+      diag[usize(a)] = 0;
+      for (isize b = 0; b < n; ++b) {
+        if (b != a && !eliminated[usize(b)] && edge(best, b))
+          edge(a, b) = 1;
+      }
+    }
+  }
+
+  // compare to the identity ordering
+  symbolic_deep_copy(in, *this, iwork);
+  performed_llt = false;
+  const bool greedy_ok = llt_in_place();
+  const isize greedy_nnz = count_nnz();
+
+  symbolic_deep_copy(in, *this);
+  performed_llt = false;
+  const bool ident_ok = llt_in_place();
+  const isize ident_nnz = count_nnz();
+
+  if (greedy_ok && (!ident_ok || greedy_nnz < ident_nnz)) {
+    std::copy_n(iwork, n, best_perm);
+    symbolic_deep_copy(in, *this, iwork);
+    performed_llt = false;
+    llt_in_place();
+  } else if (ident_ok) {
+    std::iota(best_perm, best_perm + n, isize(0));
+  } else {
+    return Eigen::NumericalIssue;
+  }
+  return Eigen::Success;
+}
+
 bool SymbolicBlockMatrix::check_if_symmetric() const noexcept {
   const isize n = nsegments();
   const auto &self = *this;
@@ -9,6 +9,10 @@ template struct PROXSUITE_NLP_EXPLICIT_INSTANTIATION_DEFINITION_DLLAPI
     PolynomialTpl<context::Scalar>;
 template class PROXSUITE_NLP_EXPLICIT_INSTANTIATION_DEFINITION_DLLAPI
     ArmijoLinesearch<context::Scalar>;
+template class PROXSUITE_NLP_EXPLICIT_INSTANTIATION_DEFINITION_DLLAPI
+    SpeculativeArmijoLinesearch<context::Scalar>;
+template class PROXSUITE_NLP_EXPLICIT_INSTANTIATION_DEFINITION_DLLAPI
+    WolfeLinesearch<context::Scalar>;
 
 } // namespace nlp
 } // namespace proxsuite
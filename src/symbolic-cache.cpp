@@ -0,0 +1,188 @@
+/// @file
+/// @copyright Copyright (C) 2024 LAAS-CNRS, INRIA
+#include "proxsuite-nlp/linalg/symbolic-cache.hpp"
+#include "proxsuite-nlp/exceptions.hpp"
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/container_hash/hash.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <fstream>
+
+namespace proxsuite {
+namespace nlp {
+namespace linalg {
+
+std::size_t hash_structure(const SymbolicBlockMatrix &in) noexcept {
+  const isize n = in.nsegments();
+  std::size_t seed = std::size_t(n);
+  for (isize i = 0; i < n; ++i)
+    boost::hash_combine(seed, in.segment_lens[i]);
+  for (isize i = 0; i < n; ++i) {
+    for (isize j = 0; j < n; ++j)
+      boost::hash_combine(seed, int(in(i, j)));
+  }
+  return seed;
+}
+
+bool SymbolicAnalysisCache::Entry::matches(const SymbolicBlockMatrix &in,
+                                           BlockOrdering m) const {
+  const isize n = in.nsegments();
+  if (method != int(m) || isize(segment_lens.size()) != n)
+    return false;
+  for (isize i = 0; i < n; ++i) {
+    if (segment_lens[std::size_t(i)] != in.segment_lens[i])
+      return false;
+    for (isize j = 0; j < n; ++j) {
+      if (pattern[std::size_t(i + j * n)] != int(in(i, j)))
+        return false;
+    }
+  }
+  return true;
+}
+
+SymbolicAnalysisCache &SymbolicAnalysisCache::instance() {
+  static SymbolicAnalysisCache cache;
+  return cache;
+}
+
+bool SymbolicAnalysisCache::find(const SymbolicBlockMatrix &in,
+                                 BlockOrdering method,
+                                 std::vector<isize> &perm) const {
+  const std::size_t key = hash_structure(in);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_enabled)
+    return false;
+  auto range = m_entries.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second.matches(in, method)) {
+      perm = it->second.perm;
+      return true;
+    }
+  }
+  return false;
+}
+
+void SymbolicAnalysisCache::insert(const SymbolicBlockMatrix &in,
+                                   BlockOrdering method,
+                                   const std::vector<isize> &perm) {
+  const isize n = in.nsegments();
+  Entry entry;
+  entry.method = int(method);
+  entry.segment_lens.assign(in.segment_lens, in.segment_lens + n);
+  entry.pattern.resize(std::size_t(n * n));
+  for (isize i = 0; i < n; ++i) {
+    for (isize j = 0; j < n; ++j)
+      entry.pattern[std::size_t(i + j * n)] = int(in(i, j));
+  }
+  entry.perm = perm;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_enabled)
+    insertEntry(hash_structure(in), std::move(entry));
+}
+
+void SymbolicAnalysisCache::insertEntry(std::size_t key, Entry &&entry) {
+  auto range = m_entries.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it) {
+    const Entry &e = it->second;
+    if (e.method == entry.method && e.segment_lens == entry.segment_lens &&
+        e.pattern == entry.pattern) {
+      it->second = std::move(entry);
+      return;
+    }
+  }
+  m_entries.emplace(key, std::move(entry));
+}
+
+std::size_t SymbolicAnalysisCache::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+void SymbolicAnalysisCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+}
+
+void SymbolicAnalysisCache::setEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_enabled = enabled;
+}
+
+bool SymbolicAnalysisCache::enabled() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_enabled;
+}
+
+void SymbolicAnalysisCache::save(const std::string &filename) const {
+  std::ofstream ofs(filename);
+  if (!ofs)
+    PROXSUITE_NLP_RUNTIME_ERROR("Could not open file " + filename);
+  std::vector<Entry> entries;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &kv : m_entries)
+      entries.push_back(kv.second);
+  }
+  boost::archive::text_oarchive oa(ofs);
+  oa << entries;
+}
+
+namespace {
+
+/// Throw if @p entry, read from a cache file, is not a valid analysis.
+void check_entry(const SymbolicAnalysisCache::Entry &entry) {
+  const std::size_t n = entry.segment_lens.size();
+  if (entry.method < int(BlockOrdering::AUTO) ||
+      entry.method > int(BlockOrdering::GREEDY) ||
+      entry.pattern.size() != n * n || entry.perm.size() != n)
+    PROXSUITE_NLP_RUNTIME_ERROR("Invalid symbolic analysis cache entry.");
+  for (int kind : entry.pattern) {
+    if (kind < int(Zero) || kind > int(Dense))
+      PROXSUITE_NLP_RUNTIME_ERROR(
+          "Invalid block kind in symbolic analysis cache entry.");
+  }
+  std::vector<char> seen(n, 0);
+  for (isize p : entry.perm) {
+    if (p < 0 || std::size_t(p) >= n || seen[std::size_t(p)])
+      PROXSUITE_NLP_RUNTIME_ERROR(
+          "Invalid permutation in symbolic analysis cache entry.");
+    seen[std::size_t(p)] = 1;
+  }
+}
+
+} // namespace
+
+void SymbolicAnalysisCache::load(const std::string &filename) {
+  std::ifstream ifs(filename);
+  if (!ifs)
+    PROXSUITE_NLP_RUNTIME_ERROR("Could not open file " + filename);
+  std::vector<Entry> entries;
+  boost::archive::text_iarchive ia(ifs);
+  ia >> entries;
+
+  // check the whole file before merging it into the cache
+  std::vector<std::size_t> keys;
+  keys.reserve(entries.size());
+  std::vector<BlockKind> data;
+  for (Entry &entry : entries) {
+    check_entry(entry);
+    // recompute the key, which depends on the hash implementation
+    const isize n = isize(entry.segment_lens.size());
+    data.resize(entry.pattern.size());
+    for (std::size_t i = 0; i < data.size(); ++i)
+      data[i] = BlockKind(entry.pattern[i]);
+    SymbolicBlockMatrix view(data.data(), entry.segment_lens.data(), n, n);
+    keys.push_back(hash_structure(view));
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (std::size_t k = 0; k < entries.size(); ++k)
+    insertEntry(keys[k], std::move(entries[k]));
+}
+
+} // namespace linalg
+} // namespace nlp
+} // namespace proxsuite
@@ -13,6 +13,8 @@
 #include "proxsuite-nlp/math.hpp"
 #include <fmt/ranges.h>
 
+#include <cstdio>
+
 BOOST_AUTO_TEST_SUITE(cholesky_sparse)
 
 namespace utf = boost::unit_test;
@@ -20,6 +22,7 @@ using namespace proxsuite::nlp;
 
 using linalg::BlockLDLT;
 using linalg::DenseLDLT;
+using linalg::SparseLDLT;
 
 constexpr isize n = 3;
 constexpr double TOL = 1e-11;
@@ -198,6 +201,304 @@ BOOST_AUTO_TEST_CASE(block_structure_allocator) {
   linalg::print_sparsity_pattern(modified_structure);
 }
 
+BOOST_AUTO_TEST_CASE(block_ldlt_many_blocks, *utf::tolerance(TOL_LOOSE)) {
+  // one primal block and many constraint blocks: the brute-force search is
+  // out of reach, the greedy ordering eliminates the constraints first
+  const isize nx = 6;
+  const std::size_t nblocks = 50;
+  std::vector<isize> nprims = {nx};
+  std::vector<isize> nduals(nblocks, 2);
+  linalg::SymbolicBlockMatrix structure =
+      create_default_block_structure(nprims, nduals);
+  const isize size = nx + 2 * isize(nblocks);
+
+  MatrixXs mat = getRandomSymmetricBlockMatrix(structure);
+  mat.topLeftCorner(nx, nx).diagonal().array() += 2. * size;
+  mat.diagonal().tail(size - nx).setConstant(-1.);
+
+  BlockLDLT<Scalar> block_ldlt(size, structure);
+  block_ldlt.findSparsifyingPermutation();
+  BOOST_REQUIRE(block_ldlt.structure().performed_llt);
+
+  auto identity = structure.copy();
+  identity.llt_in_place();
+  fmt::print("Identity nnz = {:d}, greedy nnz = {:d}\n",
+             identity.count_nnz(), block_ldlt.structure().count_nnz());
+  BOOST_CHECK_LT(block_ldlt.structure().count_nnz(), identity.count_nnz());
+  BOOST_CHECK_EQUAL(block_ldlt.blockPermIndices().back(), 0);
+
+  block_ldlt.compute(mat);
+  BOOST_REQUIRE(block_ldlt.info() == Eigen::Success);
+  BOOST_CHECK(block_ldlt.reconstructedMatrix().isApprox(mat));
+
+  MatrixXs rhs = MatrixXs::Random(size, 2);
+  MatrixXs sol = rhs;
+  block_ldlt.solveInPlace(sol);
+  BOOST_CHECK(rhs.isApprox(mat * sol));
+
+  // exact and greedy orderings agree on a small instance
+  std::vector<isize> nduals_small(4, 2);
+  auto small = create_default_block_structure(nprims, nduals_small);
+  const isize small_size = nx + 8;
+  BlockLDLT<Scalar> exact(small_size, small);
+  BlockLDLT<Scalar> greedy(small_size, small);
+  exact.findSparsifyingPermutation(linalg::BlockOrdering::BRUTE_FORCE);
+  greedy.findSparsifyingPermutation(linalg::BlockOrdering::GREEDY);
+  BOOST_CHECK_EQUAL(exact.structure().count_nnz(),
+                    greedy.structure().count_nnz());
+}
+
+BOOST_AUTO_TEST_CASE(test_ldlt_threads, *utf::tolerance(TOL_LOOSE)) {
+  // large enough to go through the recursive, panel-parallel kernel
+  const isize nx = 300;
+  const isize nc = 100;
+  const isize size = nx + nc;
+  MatrixXs H = MatrixXs::Random(nx, nx);
+  MatrixXs mat(size, size);
+  mat.setZero();
+  mat.topLeftCorner(nx, nx) = H * H.transpose();
+  mat.topLeftCorner(nx, nx).diagonal().array() += 1.;
+  mat.bottomLeftCorner(nc, nx).setRandom();
+  mat.bottomRightCorner(nc, nc).diagonal().setConstant(-1e-2);
+  mat = mat.selfadjointView<Eigen::Lower>();
+
+  DenseLDLT<Scalar> serial(size);
+  DenseLDLT<Scalar> parallel(size);
+  parallel.setNumThreads(4);
+  serial.compute(mat);
+  parallel.compute(mat);
+  BOOST_CHECK(parallel.matrixLDLT()
+                  .triangularView<Eigen::Lower>()
+                  .toDenseMatrix()
+                  .isApprox(serial.matrixLDLT()
+                                .triangularView<Eigen::Lower>()
+                                .toDenseMatrix()));
+
+  std::vector<isize> nprims = {nx};
+  std::vector<isize> nduals(10, nc / 10);
+  auto structure = create_default_block_structure(nprims, nduals);
+  BlockLDLT<Scalar> block_serial(size, structure);
+  block_serial.findSparsifyingPermutation();
+  BlockLDLT<Scalar> block_parallel(block_serial);
+  block_parallel.setNumThreads(4);
+  block_serial.compute(mat);
+  block_parallel.compute(mat);
+  BOOST_CHECK(block_parallel.reconstructedMatrix().isApprox(mat));
+  VectorXs rhs = VectorXs::Random(size);
+  VectorXs sol = rhs;
+  block_parallel.solveInPlace(sol);
+  BOOST_CHECK(rhs.isApprox(mat * sol));
+}
+
+BOOST_AUTO_TEST_CASE(test_ldlt_diagonal_update, *utf::tolerance(TOL_LOOSE)) {
+  const isize nx = 150;
+  const std::size_t nblocks = 20;
+  const isize size = nx + 2 * isize(nblocks);
+  std::vector<isize> nprims = {nx};
+  std::vector<isize> nduals(nblocks, 2);
+  auto structure = create_default_block_structure(nprims, nduals);
+  MatrixXs mat = getRandomSymmetricBlockMatrix(structure);
+  mat.topLeftCorner(nx, nx).diagonal().array() += 2. * size;
+  mat.diagonal().tail(size - nx).setConstant(-1.);
+  VectorXs rhs = VectorXs::Random(size);
+
+  // shift the dual rows, which come last
+  DenseLDLT<Scalar> dense(size);
+  dense.setUpdatableRows(nx, size - nx);
+  dense.compute(mat);
+  BOOST_CHECK(dense.updateDiagonal(-0.5));
+  MatrixXs shifted = mat;
+  shifted.diagonal().tail(size - nx).array() -= 0.5;
+  BOOST_CHECK(dense.reconstructedMatrix().isApprox(shifted));
+  VectorXs sol = rhs;
+  dense.solveInPlace(sol);
+  BOOST_CHECK(rhs.isApprox(shifted * sol));
+
+  // shift the primal rows, which the block ordering eliminates last
+  BlockLDLT<Scalar> block_ldlt(size, structure);
+  block_ldlt.findSparsifyingPermutation();
+  block_ldlt.setUpdatableRows(0, nx);
+  block_ldlt.compute(mat);
+  BOOST_CHECK(block_ldlt.updateDiagonal(1.));
+  BOOST_CHECK(block_ldlt.updateDiagonal(2.));
+  shifted = mat;
+  shifted.diagonal().head(nx).array() += 3.;
+  BOOST_REQUIRE(block_ldlt.info() == Eigen::Success);
+  BOOST_CHECK(block_ldlt.reconstructedMatrix().isApprox(shifted));
+  sol = rhs;
+  block_ldlt.solveInPlace(sol);
+  BOOST_CHECK(rhs.isApprox(shifted * sol));
+
+  // the primal rows come first: the dense factorization permutes them last
+  dense.setUpdatableRows(0, nx);
+  dense.compute(mat);
+  BOOST_CHECK(dense.reconstructedMatrix().isApprox(mat));
+  BOOST_CHECK(dense.updateDiagonal(1.));
+  BOOST_CHECK(dense.updateDiagonal(2.));
+  BOOST_CHECK(dense.reconstructedMatrix().isApprox(shifted));
+  sol = rhs;
+  dense.solveInPlace(sol);
+  BOOST_CHECK(rhs.isApprox(shifted * sol));
+
+  // updatable rows in the middle
+  dense.setUpdatableRows(nx, 4);
+  dense.compute(mat);
+  BOOST_CHECK(dense.updateDiagonal(-0.5));
+  shifted = mat;
+  shifted.diagonal().segment(nx, 4).array() -= 0.5;
+  BOOST_CHECK(dense.reconstructedMatrix().isApprox(shifted));
+  sol = rhs;
+  dense.solveInPlace(sol);
+  BOOST_CHECK(rhs.isApprox(shifted * sol));
+}
+
+BOOST_AUTO_TEST_CASE(symbolic_analysis_cache) {
+  auto &cache = linalg::SymbolicAnalysisCache::instance();
+  cache.clear();
+  std::vector<isize> nprims = {4};
+  std::vector<isize> nduals(20, 3);
+  auto structure = create_default_block_structure(nprims, nduals);
+  const isize size = 4 + 60;
+
+  BlockLDLT<Scalar> first(size, structure);
+  first.findSparsifyingPermutation();
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+
+  // a planted entry is returned instead of running the search
+  std::vector<isize> perm(21);
+  std::iota(perm.rbegin(), perm.rend(), isize(0));
+  cache.insert(structure, linalg::BlockOrdering::GREEDY, perm);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  BlockLDLT<Scalar> second(size, structure);
+  second.findSparsifyingPermutation();
+  BOOST_CHECK(second.blockPermIndices() == perm);
+
+  const std::string filename = "symbolic-cache-test.txt";
+  cache.save(filename);
+  cache.clear();
+  std::vector<isize> found;
+  BOOST_CHECK(!cache.find(structure, linalg::BlockOrdering::GREEDY, found));
+  cache.load(filename);
+  BOOST_CHECK(cache.find(structure, linalg::BlockOrdering::GREEDY, found));
+  BOOST_CHECK(found == perm);
+
+  // a file with an invalid entry is rejected as a whole
+  auto other = create_default_block_structure(nprims, {3, 3});
+  std::vector<isize> not_a_perm = {0, 0, 2};
+  cache.insert(other, linalg::BlockOrdering::GREEDY, not_a_perm);
+  cache.save(filename);
+  cache.clear();
+  BOOST_CHECK_THROW(cache.load(filename), std::runtime_error);
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+
+  // as is a file with an invalid block kind
+  cache.insert(structure, linalg::BlockOrdering::GREEDY, perm);
+  other(0, 1) = linalg::BlockKind(linalg::Dense + 1);
+  cache.insert(other, linalg::BlockOrdering::GREEDY, {2, 1, 0});
+  cache.save(filename);
+  cache.clear();
+  BOOST_CHECK_THROW(cache.load(filename), std::runtime_error);
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+  std::remove(filename.c_str());
+  cache.clear();
+}
+
+BOOST_AUTO_TEST_CASE(test_block_tridiag_ldlt, *utf::tolerance(TOL_LOOSE)) {
+  // quasi-definite block-tridiagonal matrix, with stages made of 3 positive
+  // and 2 negative directions, stored in a shuffled order
+  const std::size_t nstages = 8;
+  const isize nk = 5;
+  const isize size = isize(nstages) * nk;
+  MatrixXs ordered = MatrixXs::Zero(size, size);
+  for (std::size_t k = 0; k < nstages; k++) {
+    const isize sk = isize(k) * nk;
+    MatrixXs R = MatrixXs::Random(3, 3);
+    ordered.block(sk, sk, 3, 3) = R * R.transpose();
+    ordered.block(sk, sk, 3, 3).diagonal().array() += 1.;
+    ordered.block(sk + 3, sk, 2, 3).setRandom();
+    ordered.block(sk + 3, sk + 3, 2, 2).diagonal().setConstant(-1e-2);
+    // the constraints of stage k couple to the primal directions of stage k-1
+    if (k > 0)
+      ordered.block(sk + 3, sk - nk, 2, 3).setRandom();
+  }
+  ordered = ordered.selfadjointView<Eigen::Lower>();
+
+  Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, isize> P(size);
+  P.setIdentity();
+  P.indices().tail(size - 1).reverseInPlace();
+  std::swap(P.indices()(0), P.indices()(size / 2));
+  std::vector<isize> perm(P.indices().data(), P.indices().data() + size);
+  // mat(perm[i], perm[j]) = ordered(i, j)
+  MatrixXs mat(size, size);
+  for (isize i = 0; i < size; i++)
+    for (isize j = 0; j < size; j++)
+      mat(perm[std::size_t(i)], perm[std::size_t(j)]) = ordered(i, j);
+
+  linalg::BlockTridiagLDLT<Scalar> ldlt(perm,
+                                        std::vector<isize>(nstages, nk));
+  ldlt.compute(mat);
+  BOOST_REQUIRE(ldlt.info() == Eigen::Success);
+  BOOST_CHECK(ldlt.reconstructedMatrix().isApprox(mat));
+
+  MatrixXs rhs = MatrixXs::Random(size, 2);
+  MatrixXs sol = rhs;
+  ldlt.solveInPlace(sol);
+  BOOST_CHECK(rhs.isApprox(mat * sol));
+
+  Eigen::VectorXi signature;
+  ComputeSignatureVisitor{signature}(ldlt);
+  auto t = computeInertiaTuple(signature);
+  BOOST_CHECK_EQUAL(t[0], 3 * int(nstages));
+  BOOST_CHECK_EQUAL(t[1], 2 * int(nstages));
+}
+
+BOOST_AUTO_TEST_CASE(test_sparse_ldlt, *utf::tolerance(TOL_LOOSE)) {
+  // quasi-definite KKT-like matrix [H J^T; J -mu I] with sparse H, J
+  const isize nx = 20;
+  const isize nc = 8;
+  const isize size = nx + nc;
+  MatrixXs H = MatrixXs::Zero(nx, nx);
+  H.diagonal().setConstant(2.);
+  H.diagonal(1).setConstant(-0.5);
+  H.diagonal(-1).setConstant(-0.5);
+  MatrixXs J = MatrixXs::Zero(nc, nx);
+  for (isize i = 0; i < nc; ++i)
+    J.block(i, 2 * i, 1, 3).setRandom();
+  MatrixXs mat(size, size);
+  mat << H, J.transpose(), J, -1e-2 * MatrixXs::Identity(nc, nc);
+
+  SparseLDLT<Scalar> sparse_ldlt(size);
+  sparse_ldlt.compute(mat);
+  BOOST_REQUIRE(sparse_ldlt.info() == Eigen::Success);
+  BOOST_CHECK(sparse_ldlt.reconstructedMatrix().isApprox(mat));
+
+  MatrixXs rhs = MatrixXs::Random(size, 3);
+  MatrixXs sol = rhs;
+  sparse_ldlt.solveInPlace(sol);
+  BOOST_CHECK(rhs.isApprox(mat * sol, TOL_LOOSE));
+
+  Eigen::VectorXi signature;
+  ComputeSignatureVisitor{signature}(sparse_ldlt);
+  auto t = computeInertiaTuple(signature);
+  BOOST_CHECK_EQUAL(t[0], nx);
+  BOOST_CHECK_EQUAL(t[1], nc);
+
+  // zeroing out a row keeps the pattern, and the symbolic analysis
+  mat.row(size - 1).head(nx).setZero();
+  mat.col(size - 1).head(nx).setZero();
+  mat.diagonal().head(nx).array() += 1.;
+  sparse_ldlt.compute(mat);
+  BOOST_REQUIRE(sparse_ldlt.info() == Eigen::Success);
+  BOOST_CHECK(sparse_ldlt.reconstructedMatrix().isApprox(mat));
+  BOOST_CHECK_EQUAL(sparse_ldlt.numAnalyses(), 1);
+
+  // a new nonzero triggers a new analysis
+  mat(nx - 1, 0) = mat(0, nx - 1) = 0.1;
+  sparse_ldlt.compute(mat);
+  BOOST_CHECK(sparse_ldlt.reconstructedMatrix().isApprox(mat));
+  BOOST_CHECK_EQUAL(sparse_ldlt.numAnalyses(), 2);
+}
+
 #ifdef PROXSUITE_NLP_USE_PROXSUITE_LDLT
 
 BOOST_FIXTURE_TEST_CASE(test_proxsuite_ldlt, ldlt_test_fixture,
@@ -25,8 +25,8 @@ using C2Function = C2FunctionTpl<Scalar>;
 struct CustomC2Func : C2FunctionTpl<Scalar> {
 
   CustomC2Func() : C2FunctionTpl<Scalar>(SE2(), 1) {}
-  VectorXs operator()(const ConstVectorRef &) const {
-    return VectorXs::Random(nr());
+  void evaluate(const ConstVectorRef &, VectorRef out) const {
+    out.setRandom();
   }
 
   void computeJacobian(const ConstVectorRef &, MatrixRef Jout) const {
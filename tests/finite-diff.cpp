@@ -26,11 +26,9 @@ struct MyFuncType : C1FunctionTpl<double> {
 
   VectorXs refpt;
 
-  VectorXs operator()(const ConstVectorRef &x) const {
-    VectorXs out(1);
+  void evaluate(const ConstVectorRef &x, VectorRef out) const {
     VectorXs err = space.difference(x, refpt);
-    out << 1. / 3. * std::pow(err.lpNorm<3>(), 3);
-    return out;
+    out(0) = 1. / 3. * std::pow(err.lpNorm<3>(), 3);
   }
 
   void computeJacobian(const ConstVectorRef &x, MatrixRef Jout) const {
@@ -1,6 +1,7 @@
 #include "proxsuite-nlp/modelling/residuals/linear.hpp"
 #include "proxsuite-nlp/function-ops.hpp"
 #include "proxsuite-nlp/modelling/costs/squared-distance.hpp"
+#include "proxsuite-nlp/modelling/spaces/vector-space.hpp"
 
 #include <boost/test/unit_test.hpp>
 #include <boost/utility/binary.hpp>
@@ -64,4 +65,28 @@ BOOST_AUTO_TEST_CASE(test_compose) {
   BOOST_CHECK(v1_manual.isApprox(v0));
 }
 
+BOOST_AUTO_TEST_CASE(test_cost_jacobian) {
+  const int N = 4;
+  auto space = std::make_shared<VectorSpaceTpl<double>>(N);
+  Eigen::VectorXd target = Eigen::VectorXd::Random(N);
+  QuadraticDistanceCostTpl<double> cost(space, target);
+  Eigen::VectorXd x0 = Eigen::VectorXd::Random(N);
+  Eigen::VectorXd grad(N);
+  cost.call(x0);
+  cost.computeGradient(x0, grad);
+
+  // the row of a stacked Jacobian is strided
+  Eigen::MatrixXd J0(1, N), Jstack(3, N);
+  Jstack.setZero();
+  PROXSUITE_NLP_NOMALLOC_BEGIN;
+  cost.computeJacobian(x0, J0);
+  cost.computeJacobian(x0, Jstack.middleRows(1, 1));
+  PROXSUITE_NLP_NOMALLOC_END;
+
+  BOOST_CHECK(J0.transpose().isApprox(grad));
+  BOOST_CHECK(Jstack.row(1).transpose().isApprox(grad));
+  BOOST_CHECK(Jstack.row(0).isZero());
+  BOOST_CHECK(Jstack.row(2).isZero());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
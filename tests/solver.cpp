@@ -1,11 +1,844 @@
 #include "proxsuite-nlp/prox-solver.hpp"
+#include "proxsuite-nlp/batched-solver.hpp"
+#include "proxsuite-nlp/cost-sum.hpp"
+#include "proxsuite-nlp/modelling/residuals/linear.hpp"
+#include "proxsuite-nlp/modelling/constraints/negative-orthant.hpp"
+#include "proxsuite-nlp/modelling/spaces/vector-space.hpp"
+#include "proxsuite-nlp/modelling/spaces/cartesian-product.hpp"
 
 #include <boost/test/unit_test.hpp>
+#include <atomic>
 
 BOOST_AUTO_TEST_SUITE(solver)
 
 using namespace proxsuite::nlp;
+using Scalar = double;
+PROXSUITE_NLP_DYNAMIC_TYPEDEFS(Scalar);
+using Manifold = VectorSpaceTpl<Scalar>;
+using Problem = ProblemTpl<Scalar>;
+using Solver = ProxNLPSolverTpl<Scalar>;
+
+/// Equality-constrained QP with a random positive-definite cost.
+shared_ptr<Problem> createEqualityQp(const int nx, const int nc) {
+  auto space = std::make_shared<Manifold>(nx);
+  MatrixXs Qroot = MatrixXs::Random(nx, nx + 1);
+  MatrixXs Q = Qroot * Qroot.transpose() / nx;
+  auto cost = std::make_shared<QuadraticDistanceCostTpl<Scalar>>(
+      space, space->rand(), Q);
+  MatrixXs A = MatrixXs::Random(nc, nx);
+  VectorXs b = VectorXs::Random(nc);
+  auto func = std::make_shared<LinearFunctionTpl<Scalar>>(A, b);
+  std::vector<Problem::ConstraintObject> cstrs;
+  cstrs.emplace_back(func, std::make_shared<EqualityConstraint<Scalar>>());
+  return std::make_shared<Problem>(space, cost, cstrs);
+}
+
+/// Separable quadratic cost \f$ \frac12 (x - t)^\top W (x - t) \f$, with a
+/// sparse Hessian.
+struct DiagonalQuadraticCost : CostFunctionBaseTpl<Scalar> {
+  VectorXs weights;
+  VectorXs target;
+  mutable int num_hessians = 0;
+  mutable int num_sparse_hessians = 0;
+  DiagonalQuadraticCost(const VectorXs &weights, const VectorXs &target)
+      : CostFunctionBaseTpl<Scalar>(int(weights.size()), int(weights.size())),
+        weights(weights), target(target) {}
+  Scalar call(const ConstVectorRef &x) const {
+    return 0.5 * (x - target).dot(weights.cwiseProduct(x - target));
+  }
+  void computeGradient(const ConstVectorRef &x, VectorRef out) const {
+    out = weights.cwiseProduct(x - target);
+  }
+  void computeHessian(const ConstVectorRef &, MatrixRef out) const {
+    num_hessians++;
+    out.setZero();
+    out.diagonal() = weights;
+  }
+  void computeSparseHessian(const ConstVectorRef &, BaseData *,
+                            SparseMatrixXs &out) const {
+    num_sparse_hessians++;
+    const int n = ndx();
+    out.resize(n, n);
+    out.reserve(Eigen::VectorXi::Ones(n));
+    for (int i = 0; i < n; i++)
+      out.insert(i, i) = weights(i);
+    out.makeCompressed();
+  }
+};
 
 BOOST_AUTO_TEST_CASE(solve) {}
 
+BOOST_AUTO_TEST_CASE(warm_start) {
+  auto problem = createEqualityQp(8, 3);
+  Solver solver(problem, 1e-8);
+  solver.warm_start_ = true;
+  solver.setup();
+
+  VectorXs x0 = problem->manifold().neutral();
+  BOOST_CHECK_EQUAL(solver.solve(x0), ConvergenceFlag::SUCCESS);
+  const std::size_t cold_iters = solver.getResults().num_iters;
+
+  VectorXs xopt = solver.getResults().x_opt;
+  BOOST_CHECK_EQUAL(solver.solve(xopt), ConvergenceFlag::SUCCESS);
+  BOOST_CHECK_LE(solver.getResults().num_iters, 1);
+  BOOST_CHECK_LE(solver.getResults().num_iters, cold_iters);
+  BOOST_CHECK(solver.getResults().x_opt.isApprox(xopt, 1e-6));
+}
+
+BOOST_AUTO_TEST_CASE(kkt_condensed) {
+  const int nx = 10;
+  auto problem = createEqualityQp(nx, 4);
+  VectorXs x0 = problem->manifold().neutral();
+
+  Solver solver(problem, 1e-8);
+  solver.kkt_system_ = KKT_CONDENSED;
+  solver.setup();
+  BOOST_CHECK_EQUAL(solver.solve(x0), ConvergenceFlag::SUCCESS);
+
+  // only the primal Schur complement is assembled and factorized
+  const auto &ws = solver.getWorkspace();
+  BOOST_CHECK(ws.kkt_matrix.isZero(0.));
+  BOOST_CHECK_EQUAL(ws.llt_condensed.info(), Eigen::Success);
+  BOOST_CHECK_EQUAL(ws.llt_condensed.matrixLLT().rows(), nx);
+}
+
+BOOST_AUTO_TEST_CASE(kkt_reduced) {
+  // many inequality constraints, only a few of which are active
+  const int nx = 10;
+  const int nc = 40;
+  auto space = std::make_shared<Manifold>(nx);
+  auto cost = std::make_shared<QuadraticDistanceCostTpl<Scalar>>(
+      space, VectorXs::Constant(nx, 2.), MatrixXs::Identity(nx, nx));
+  VectorXs b = VectorXs::Constant(nc, -100.);
+  b.head(3).setConstant(-1.);
+  auto ineq = std::make_shared<LinearFunctionTpl<Scalar>>(
+      MatrixXs::Random(nc, nx), b);
+  auto eq = std::make_shared<LinearFunctionTpl<Scalar>>(MatrixXs::Random(2, nx),
+                                                        VectorXs::Random(2));
+  std::vector<Problem::ConstraintObject> cstrs;
+  cstrs.emplace_back(eq, std::make_shared<EqualityConstraint<Scalar>>());
+  cstrs.emplace_back(ineq, std::make_shared<NegativeOrthant<Scalar>>());
+  auto problem = std::make_shared<Problem>(space, cost, cstrs);
+  VectorXs x0 = space->neutral();
+
+  for (KktSystem kkt_system : {KKT_CLASSIC, KKT_PRIMAL_DUAL}) {
+    Solver solver(problem, 1e-8);
+    solver.kkt_system_ = kkt_system;
+    solver.reduced_kkt_ = true;
+    solver.setup();
+    BOOST_CHECK_EQUAL(solver.solve(x0), ConvergenceFlag::SUCCESS);
+
+    // only the primal rows and the rows of the active constraints are
+    // factorized: the equalities, and at most the first inequalities
+    const auto &ws = solver.getWorkspace();
+    BOOST_CHECK(ws.kkt_active.head(2).all());
+    BOOST_CHECK(!ws.kkt_active.tail(nc - 3).any());
+    BOOST_CHECK_EQUAL(ws.kkt_reduced_size, nx + ws.kkt_active.count());
+  }
+
+  Solver solver_block(problem, 1e-8);
+  solver_block.ldlt_choice_ = LDLTChoice::BLOCKSPARSE;
+  solver_block.reduced_kkt_ = true;
+  BOOST_CHECK_THROW(solver_block.setup(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(ldlt_sparse) {
+  auto problem = createEqualityQp(12, 5);
+  VectorXs x0 = problem->manifold().neutral();
+
+  Solver solver(problem, 1e-8);
+  solver.ldlt_choice_ = LDLTChoice::SPARSE;
+  solver.setup();
+  BOOST_CHECK_EQUAL(solver.solve(x0), ConvergenceFlag::SUCCESS);
+  BOOST_CHECK_GT(solver.getResults().num_iters, 1);
+
+  // the KKT pattern does not change across the iterations: it is only
+  // analyzed once
+  const auto &ldlt =
+      boost::get<linalg::SparseLDLT<Scalar>>(solver.getWorkspace().ldlt_);
+  BOOST_CHECK_EQUAL(ldlt.numAnalyses(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ldlt_dense_update) {
+  // nonconvex QP in a box: the inertia correction is needed
+  const int nx = 8;
+  auto space = std::make_shared<Manifold>(nx);
+  MatrixXs weights = MatrixXs::Identity(nx, nx);
+  weights.diagonal().head(nx / 2).setConstant(-0.3);
+  auto cost = std::make_shared<QuadraticDistanceCostTpl<Scalar>>(
+      space, VectorXs::Random(nx), weights);
+  MatrixXs A(2 * nx, nx);
+  A << MatrixXs::Identity(nx, nx), -MatrixXs::Identity(nx, nx);
+  auto box = std::make_shared<LinearFunctionTpl<Scalar>>(
+      A, -VectorXs::Ones(2 * nx));
+  std::vector<Problem::ConstraintObject> cstrs;
+  cstrs.emplace_back(box, std::make_shared<NegativeOrthant<Scalar>>());
+  auto problem = std::make_shared<Problem>(space, cost, cstrs);
+  VectorXs x0 = space->neutral();
+
+  Solver solver(problem, 1e-8);
+  solver.setup();
+  BOOST_CHECK_EQUAL(solver.solve(x0), ConvergenceFlag::SUCCESS);
+  BOOST_CHECK_EQUAL(solver.getWorkspace().num_ldlt_updates, 0);
+
+  // the regularization only shifts the primal block, whose Schur complement
+  // is refactorized
+  Solver solver_dense(problem, 1e-8);
+  solver_dense.ldlt_choice_ = LDLTChoice::DENSE;
+  solver_dense.setup();
+  BOOST_CHECK_EQUAL(solver_dense.solve(x0), ConvergenceFlag::SUCCESS);
+  BOOST_CHECK_GT(solver_dense.getWorkspace().num_ldlt_updates, 0);
+  BOOST_CHECK(solver_dense.getWorkspace().ldlt_updatable);
+
+  // without any retry of the inertia correction, the factorization is not
+  // reordered
+  auto qp = createEqualityQp(nx, 2);
+  Solver solver_qp(qp, 1e-8);
+  solver_qp.ldlt_choice_ = LDLTChoice::DENSE;
+  solver_qp.setup();
+  BOOST_CHECK_EQUAL(solver_qp.solve(qp->manifold().neutral()),
+                    ConvergenceFlag::SUCCESS);
+  BOOST_CHECK(!solver_qp.getWorkspace().ldlt_updatable);
+  BOOST_CHECK_EQUAL(solver_qp.getWorkspace().num_ldlt_updates, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ldlt_block_structure) {
+  // each constraint only touches one component of the product space
+  const int ncomp = 5;
+  const int nk = 2;
+  std::vector<shared_ptr<ManifoldAbstractTpl<Scalar>>> comps;
+  for (int k = 0; k < ncomp; k++)
+    comps.push_back(std::make_shared<Manifold>(nk));
+  auto space = std::make_shared<CartesianProductTpl<Scalar>>(comps);
+  const int nx = ncomp * nk;
+  auto cost = std::make_shared<QuadraticDistanceCostTpl<Scalar>>(
+      space, space->rand(), MatrixXs::Identity(nx, nx));
+  std::vector<Problem::ConstraintObject> cstrs;
+  for (int k = 0; k < ncomp; k++) {
+    MatrixXs A = MatrixXs::Zero(1, nx);
+    A.middleCols(k * nk, nk).setRandom();
+    auto func =
+        std::make_shared<LinearFunctionTpl<Scalar>>(A, VectorXs::Random(1));
+    func->setComponentDependencies({std::size_t(k)});
+    cstrs.emplace_back(func, std::make_shared<EqualityConstraint<Scalar>>());
+  }
+  auto problem = std::make_shared<Problem>(space, cost, cstrs);
+
+  linalg::SymbolicBlockMatrix structure =
+      create_problem_block_structure(*problem);
+  BOOST_CHECK_EQUAL(structure.nsegments(), 2 * ncomp);
+  for (int k = 0; k < ncomp; k++) {
+    for (int j = 0; j < ncomp; j++) {
+      const auto kind = structure(ncomp + k, j);
+      BOOST_CHECK_EQUAL(kind, k == j ? linalg::Dense : linalg::Zero);
+    }
+  }
+
+  // the factorization keeps the constraint blocks decoupled
+  VectorXs x0 = space->neutral();
+  Solver solver(problem, 1e-8);
+  solver.ldlt_choice_ = LDLTChoice::BLOCKSPARSE;
+  solver.setup();
+  BOOST_CHECK_EQUAL(solver.solve(x0), ConvergenceFlag::SUCCESS);
+  const auto &ldlt =
+      boost::get<linalg::BlockLDLT<Scalar>>(solver.getWorkspace().ldlt_);
+  const linalg::SymbolicBlockMatrix &factor = ldlt.structure();
+  BOOST_CHECK_EQUAL(factor.nsegments(), 2 * ncomp);
+  int num_zeros = 0;
+  for (isize i = 0; i < factor.nsegments(); i++)
+    for (isize j = 0; j < factor.nsegments(); j++)
+      num_zeros += factor(i, j) == linalg::Zero;
+  BOOST_CHECK_GE(num_zeros, ncomp * (ncomp - 1));
+
+  // the quasi-Newton Hessian couples all components
+  linalg::SymbolicBlockMatrix qn_structure =
+      create_problem_block_structure(*problem, true);
+  for (int k = 0; k < ncomp; k++) {
+    for (int j = 0; j < ncomp; j++)
+      BOOST_CHECK_EQUAL(qn_structure(k, j), linalg::Dense);
+  }
+  Solver solver_qn(problem, 1e-8);
+  solver_qn.ldlt_choice_ = LDLTChoice::BLOCKSPARSE;
+  solver_qn.hess_approx = HessianApprox::BFGS;
+  solver_qn.setup();
+  BOOST_CHECK_EQUAL(solver_qn.solve(x0), ConvergenceFlag::SUCCESS);
+}
+
+BOOST_AUTO_TEST_CASE(ldlt_block_tridiag) {
+  // linear dynamics x_{k+1} = A x_k over a horizon, from a fixed x_0
+  const int nsteps = 20;
+  const int nk = 2;
+  std::vector<shared_ptr<ManifoldAbstractTpl<Scalar>>> comps;
+  for (int k = 0; k <= nsteps; k++)
+    comps.push_back(std::make_shared<Manifold>(nk));
+  auto space = std::make_shared<CartesianProductTpl<Scalar>>(comps);
+  const int nx = space->ndx();
+  auto cost = std::make_shared<QuadraticDistanceCostTpl<Scalar>>(
+      space, space->rand(), MatrixXs::Identity(nx, nx));
+  std::vector<Problem::ConstraintObject> cstrs;
+  {
+    MatrixXs E = MatrixXs::Zero(nk, nx);
+    E.leftCols(nk).setIdentity();
+    auto func =
+        std::make_shared<LinearFunctionTpl<Scalar>>(E, VectorXs::Ones(nk));
+    func->setComponentDependencies({0});
+    cstrs.emplace_back(func, std::make_shared<EqualityConstraint<Scalar>>());
+  }
+  MatrixXs A(nk, nk);
+  A << 1., 0.1, 0., 1.;
+  for (int k = 0; k < nsteps; k++) {
+    MatrixXs E = MatrixXs::Zero(nk, nx);
+    E.middleCols(k * nk, nk) = A;
+    E.middleCols((k + 1) * nk, nk) = -MatrixXs::Identity(nk, nk);
+    auto func =
+        std::make_shared<LinearFunctionTpl<Scalar>>(E, VectorXs::Zero(nk));
+    func->setComponentDependencies({std::size_t(k), std::size_t(k + 1)});
+    cstrs.emplace_back(func, std::make_shared<EqualityConstraint<Scalar>>());
+  }
+  auto problem = std::make_shared<Problem>(space, cost, cstrs);
+
+  VectorXs x0 = space->neutral();
+  Solver solver(problem, 1e-8);
+  solver.ldlt_choice_ = LDLTChoice::BLOCKTRIDIAG;
+  solver.setup();
+  BOOST_CHECK_EQUAL(solver.solve(x0), ConvergenceFlag::SUCCESS);
+
+  // one stage per component, with the constraints ending on it: the factorized
+  // blocks do not grow with the horizon
+  const auto &ldlt = boost::get<linalg::BlockTridiagLDLT<Scalar>>(
+      solver.getWorkspace().ldlt_);
+  BOOST_CHECK_EQUAL(ldlt.numStages(), std::size_t(nsteps + 1));
+  for (std::size_t k = 0; k < ldlt.numStages(); k++)
+    BOOST_CHECK_EQUAL(ldlt.stageDim(k), 2 * nk);
+}
+
+BOOST_AUTO_TEST_CASE(hessian_bfgs) {
+  const int nx = 8;
+  auto space = std::make_shared<Manifold>(nx);
+  auto cost = std::make_shared<DiagonalQuadraticCost>(
+      VectorXs::Random(nx).array() + 2., VectorXs::Random(nx));
+  auto func = std::make_shared<LinearFunctionTpl<Scalar>>(
+      MatrixXs::Random(3, nx), VectorXs::Random(3));
+  std::vector<Problem::ConstraintObject> cstrs;
+  cstrs.emplace_back(func, std::make_shared<EqualityConstraint<Scalar>>());
+  auto problem = std::make_shared<Problem>(space, cost, cstrs);
+
+  Solver solver(problem, 1e-8);
+  solver.hess_approx = HessianApprox::BFGS;
+  solver.setup();
+  BOOST_CHECK_EQUAL(solver.solve(space->neutral()), ConvergenceFlag::SUCCESS);
+
+  // only first-order derivatives are evaluated
+  BOOST_CHECK_EQUAL(cost->num_hessians, 0);
+  BOOST_CHECK_EQUAL(cost->num_sparse_hessians, 0);
+  // the approximation was updated, and stays positive-definite
+  const auto &ws = solver.getWorkspace();
+  BOOST_CHECK(ws.qn_scaled);
+  BOOST_CHECK(ws.qn_hessian.isApprox(ws.qn_hessian.transpose()));
+  BOOST_CHECK_EQUAL(ws.qn_hessian.llt().info(), Eigen::Success);
+}
+
+BOOST_AUTO_TEST_CASE(linesearch_wolfe) {
+  // the full step overshoots the minimizer of this quadratic
+  auto phi = [](Scalar a, Scalar &dphi) {
+    dphi = 2. * (a - 0.3);
+    return (a - 0.3) * (a - 0.3);
+  };
+  Linesearch<Scalar>::Options options;
+  Scalar alpha;
+  Scalar dphi;
+  Scalar phi_opt = WolfeLinesearch<Scalar>(options).run(phi, 0.09, -0.6, alpha);
+  BOOST_CHECK_EQUAL(phi_opt, phi(alpha, dphi));
+  BOOST_CHECK_LE(phi_opt, 0.09 - options.armijo_c1 * alpha * 0.6);
+  BOOST_CHECK_LE(std::abs(dphi), options.wolfe_c2 * 0.6);
+
+  auto problem = createEqualityQp(8, 3);
+  VectorXs x0 = problem->manifold().neutral();
+  Solver solver(problem, 1e-8);
+  solver.ls_strat = LinesearchStrategy::WOLFE;
+  solver.hess_approx = HessianApprox::BFGS;
+  solver.setup();
+  BOOST_CHECK_EQUAL(solver.solve(x0), ConvergenceFlag::SUCCESS);
+}
+
+BOOST_AUTO_TEST_CASE(linesearch_speculative) {
+  auto phi_batch = [](const std::vector<Scalar> &alphas,
+                      std::vector<Scalar> &values) {
+    for (std::size_t k = 0; k < alphas.size(); k++)
+      values[k] = (alphas[k] - 0.1) * (alphas[k] - 0.1);
+  };
+  Linesearch<Scalar>::Options options;
+  Scalar alpha;
+  Scalar phi_opt = SpeculativeArmijoLinesearch<Scalar>(options, 4).run(
+      phi_batch, 0.01, -0.2, alpha);
+  // largest step of the ladder 1, 0.5, 0.25, 0.125 with sufficient decrease
+  BOOST_CHECK_EQUAL(alpha, 0.125);
+  BOOST_CHECK_CLOSE(phi_opt, 0.025 * 0.025, 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(trial_workspace) {
+  const int nx = 6;
+  auto problem = createEqualityQp(nx, 2);
+  problem->addConstraint(Problem::ConstraintObject(
+      std::make_shared<LinearFunctionTpl<Scalar>>(MatrixXs::Random(3, nx),
+                                                  VectorXs::Random(3)),
+      std::make_shared<NegativeOrthant<Scalar>>()));
+  Solver solver(problem, 1e-8);
+  solver.max_iters = 2;
+  solver.setup();
+  solver.solve(problem->manifold().rand());
+
+  WorkspaceTpl<Scalar> &workspace = *solver.workspace_;
+  WorkspaceTpl<Scalar> ws_trial(*problem, WorkspaceTpl<Scalar>::TrialTag());
+  BOOST_CHECK_EQUAL(ws_trial.kkt_matrix.size(), 0);
+  BOOST_CHECK_EQUAL(ws_trial.data_jacobians.size(), 0);
+  BOOST_CHECK_EQUAL(ws_trial.data_hessians.size(), 0);
+  BOOST_CHECK_EQUAL(ws_trial.qn_hessian.size(), 0);
+
+  workspace.pd_step.setRandom();
+  ws_trial.pd_step = workspace.pd_step;
+  ws_trial.data_lams_prev = workspace.data_lams_prev;
+  const auto &results = *solver.results_;
+  const Scalar phi = solver.evaluateTrialMerit(workspace, results, 0.5);
+  BOOST_CHECK_CLOSE(solver.evaluateTrialMerit(ws_trial, results, 0.5), phi,
+                    1e-10);
+}
+
+/// Sphere constraint \f$ c(x) = \frac{1}{2}\|x - x_0\|^2 - r \f$.
+struct SphereFunction : C2FunctionTpl<Scalar> {
+  VectorXs center;
+  Scalar radius;
+  SphereFunction(const VectorXs &center, Scalar radius)
+      : C2FunctionTpl<Scalar>(int(center.size()), int(center.size()), 1),
+        center(center), radius(radius) {}
+  void evaluate(const ConstVectorRef &x, VectorRef out) const {
+    out(0) = 0.5 * (x - center).squaredNorm() - radius;
+  }
+  void computeJacobian(const ConstVectorRef &x, MatrixRef Jout) const {
+    Jout = (x - center).transpose();
+  }
+  void vectorHessianProduct(const ConstVectorRef &, const ConstVectorRef &v,
+                            MatrixRef Hout) const {
+    Hout.setIdentity();
+    Hout *= v(0);
+  }
+};
+
+BOOST_AUTO_TEST_CASE(accumulate_hessians) {
+  const int nx = 5;
+  auto problem = createEqualityQp(nx, 1);
+  for (int i = 0; i < 4; i++) {
+    auto func = std::make_shared<SphereFunction>(VectorXs::Random(nx), 2.);
+    problem->addConstraint(Problem::ConstraintObject(
+        func, std::make_shared<NegativeOrthant<Scalar>>()));
+  }
+  WorkspaceTpl<Scalar> ws(*problem);
+  WorkspaceTpl<Scalar> ws_acc(*problem, LDLTChoice::DENSE, false, true);
+  BOOST_CHECK_EQUAL(ws_acc.data_hessians.size(), 0);
+  VectorXs x0 = problem->manifold().rand();
+  ws.data_lams_pdal.setRandom();
+  ws_acc.data_lams_pdal = ws.data_lams_pdal;
+
+  problem->computeHessians(x0, ws, true);
+  problem->computeHessians(x0, ws_acc, true);
+  MatrixXs hess_sum = MatrixXs::Zero(nx, nx);
+  for (const auto &hess : ws.cstr_vector_hessian_prod)
+    hess_sum += hess;
+  BOOST_CHECK(ws_acc.cstr_lagrangian_hessian.isApprox(hess_sum));
+
+  // the solver workspace does not store the per-block products either
+  Solver solver(problem, 1e-8);
+  solver.hess_approx = HessianApprox::EXACT;
+  solver.accumulate_hessians_ = true;
+  solver.setup();
+  BOOST_CHECK_EQUAL(solver.solve(problem->manifold().neutral()),
+                    ConvergenceFlag::SUCCESS);
+  BOOST_CHECK_EQUAL(solver.getWorkspace().data_hessians.size(), 0);
+  BOOST_CHECK_EQUAL(solver.getWorkspace().cstr_lagrangian_hessian.rows(), nx);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_kkt) {
+  // chain of differences, with a few spheres
+  const int nx = 20;
+  auto space = std::make_shared<Manifold>(nx);
+  auto cost = std::make_shared<DiagonalQuadraticCost>(
+      VectorXs::Random(nx).array() + 2., VectorXs::Random(nx));
+  MatrixXs A = MatrixXs::Zero(nx - 1, nx);
+  for (int k = 0; k < nx - 1; k++) {
+    A(k, k) = -1.;
+    A(k, k + 1) = 1.;
+  }
+  auto diff = std::make_shared<LinearFunctionTpl<Scalar>>(
+      A, 0.1 * VectorXs::Random(nx - 1));
+  std::vector<Problem::ConstraintObject> cstrs;
+  cstrs.emplace_back(diff, std::make_shared<EqualityConstraint<Scalar>>());
+  for (int i = 0; i < 2; i++)
+    cstrs.emplace_back(
+        std::make_shared<SphereFunction>(VectorXs::Random(nx), 8.),
+        std::make_shared<NegativeOrthant<Scalar>>());
+  auto problem = std::make_shared<Problem>(space, cost, cstrs);
+  VectorXs x0 = space->neutral();
+
+  Solver solver_sparse(problem, 1e-8);
+  solver_sparse.hess_approx = HessianApprox::EXACT;
+  solver_sparse.sparse_kkt_ = true;
+  BOOST_CHECK_THROW(solver_sparse.setup(), std::runtime_error);
+  solver_sparse.ldlt_choice_ = LDLTChoice::SPARSE;
+  solver_sparse.setup();
+  BOOST_CHECK_EQUAL(solver_sparse.solve(x0), ConvergenceFlag::SUCCESS);
+  BOOST_CHECK_GT(cost->num_sparse_hessians, 0);
+  BOOST_CHECK_EQUAL(cost->num_hessians, 0);
+
+  // no dense buffer is allocated, and the pattern does not change
+  const auto &ws = solver_sparse.getWorkspace();
+  BOOST_CHECK_EQUAL(ws.kkt_matrix.size(), 0);
+  BOOST_CHECK_EQUAL(ws.data_jacobians.size(), 0);
+  BOOST_CHECK_EQUAL(ws.objective_hessian.size(), 0);
+  BOOST_CHECK_EQUAL(ws.prox_hess.size(), 0);
+  const long ntot = ws.kkt_rhs.size();
+  BOOST_CHECK_LT(ws.kkt_sparse.nonZeros(), ntot * (ntot + 1) / 4);
+  const auto &ldlt = boost::get<linalg::SparseLDLT<Scalar>>(ws.ldlt_);
+  BOOST_CHECK_EQUAL(ldlt.numAnalyses(), 1);
+}
+
+/// Linear function counting its fused value and Jacobian evaluations.
+struct CountingLinearFunction : LinearFunctionTpl<Scalar> {
+  mutable int num_fused = 0;
+  CountingLinearFunction(const MatrixXs &A, const VectorXs &b)
+      : LinearFunctionTpl<Scalar>(A, b) {}
+  void computeValueAndJacobian(const ConstVectorRef &x, VectorRef out,
+                               MatrixRef Jout) const {
+    num_fused++;
+    LinearFunctionTpl<Scalar>::computeValueAndJacobian(x, out, Jout);
+  }
+};
+
+BOOST_AUTO_TEST_CASE(fused_value_jacobian) {
+  const int nx = 6;
+  auto problem = createEqualityQp(nx, 2);
+  auto func = std::make_shared<CountingLinearFunction>(MatrixXs::Random(2, nx),
+                                                       VectorXs::Random(2));
+  problem->addConstraint(Problem::ConstraintObject(
+      func, std::make_shared<NegativeOrthant<Scalar>>()));
+  Solver solver(problem, 1e-8);
+  solver.setup();
+  BOOST_CHECK_EQUAL(solver.solve(problem->manifold().neutral()),
+                    ConvergenceFlag::SUCCESS);
+  BOOST_CHECK_GT(func->num_fused, 0);
+  // at most one fused evaluation per inner iteration, plus the final one of
+  // each subproblem
+  const auto &results = solver.getResults();
+  BOOST_CHECK_LE(std::size_t(func->num_fused),
+                 results.num_iters + results.al_iters + 1);
+}
+
+BOOST_AUTO_TEST_CASE(function_data) {
+  const int nx = 4;
+  auto space = std::make_shared<Manifold>(nx);
+  shared_ptr<CostFunctionBaseTpl<Scalar>> cost1 =
+      std::make_shared<QuadraticDistanceCostTpl<Scalar>>(space, space->rand());
+  shared_ptr<CostFunctionBaseTpl<Scalar>> cost2 =
+      std::make_shared<QuadraticDistanceCostTpl<Scalar>>(space, space->rand());
+  auto cost = 0.5 * cost1 + cost2;
+  VectorXs x1 = space->rand();
+  VectorXs x2 = space->rand();
+
+  // reference values, through the default data
+  const Scalar val1 = cost->call(x1);
+  VectorXs g1(nx), g2(nx), g(nx);
+  cost->computeGradient(x1, g1);
+  cost->call(x2);
+  cost->computeGradient(x2, g2);
+
+  // interleaved evaluations on separate data must not interfere
+  auto d1 = cost->createData();
+  auto d2 = cost->createData();
+  BOOST_CHECK_EQUAL(cost->call(x1, d1.get()), val1);
+  cost->call(x2, d2.get());
+  cost->computeGradient(x1, d1.get(), g);
+  BOOST_CHECK(g.isApprox(g1));
+  cost->computeGradient(x2, d2.get(), g);
+  BOOST_CHECK(g.isApprox(g2));
+
+  // each workspace holds its own data
+  auto problem = createEqualityQp(nx, 2);
+  WorkspaceTpl<Scalar> ws1(*problem), ws2(*problem);
+  BOOST_CHECK(ws1.cost_data != nullptr);
+  BOOST_CHECK(ws1.cost_data != ws2.cost_data);
+  problem->evaluate(x1, ws1);
+  problem->evaluate(x2, ws2);
+  problem->computeDerivatives(x1, ws1);
+  problem->computeDerivatives(x2, ws2);
+  problem->cost().call(x1);
+  problem->cost().computeGradient(x1, g1);
+  BOOST_CHECK(ws1.objective_gradient.isApprox(g1));
+}
+
+BOOST_AUTO_TEST_CASE(solve_batch) {
+  const int nx = 6;
+  auto problem = createEqualityQp(nx, 2);
+  auto func = std::make_shared<LinearFunctionTpl<Scalar>>(
+      MatrixXs::Random(3, nx), VectorXs::Random(3));
+  problem->addConstraint(Problem::ConstraintObject(
+      func, std::make_shared<NegativeOrthant<Scalar>>()));
+
+  Solver solver(problem, 1e-8);
+  BOOST_CHECK_THROW(solver.solveBatch({}), std::runtime_error);
+  solver.setBatchNumThreads(omp::get_available_threads());
+  solver.setup();
+  std::vector<VectorXs> x0s;
+  for (int i = 0; i < 8; i++)
+    x0s.push_back(problem->manifold().rand());
+  const auto flags = solver.solveBatch(x0s);
+  BOOST_CHECK_EQUAL(flags.size(), x0s.size());
+
+  // each instance has its own results, and the workers leave the state of
+  // the solver untouched
+  for (std::size_t i = 0; i < x0s.size(); i++) {
+    const auto &res = solver.getBatchResults(i);
+    BOOST_CHECK_EQUAL(flags[i], ConvergenceFlag::SUCCESS);
+    BOOST_CHECK_EQUAL(res.converged, flags[i]);
+    BOOST_CHECK_GT(res.num_iters, 0);
+    BOOST_CHECK_LE(std::max(res.prim_infeas, res.dual_infeas), 1e-8);
+  }
+  BOOST_CHECK_EQUAL(solver.getResults().num_iters, 0);
+
+  // a failing instance is flagged without affecting the others
+  x0s[1].setConstant(std::numeric_limits<Scalar>::quiet_NaN());
+  const auto flags_fail = solver.solveBatch(x0s);
+  BOOST_CHECK_EQUAL(flags_fail[1], ConvergenceFlag::FAILED);
+  BOOST_CHECK_EQUAL(solver.getBatchResults(1).converged,
+                    ConvergenceFlag::FAILED);
+  for (std::size_t i = 0; i < x0s.size(); i++) {
+    if (i != 1)
+      BOOST_CHECK_EQUAL(flags_fail[i], flags[i]);
+  }
+
+  // setup() drops the results of the previous batch
+  solver.setup();
+  BOOST_CHECK_THROW(solver.getBatchResults(0), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(batched_solver) {
+  const int nx = 6;
+  auto problem = createEqualityQp(nx, 2);
+  problem->addConstraint(Problem::ConstraintObject(
+      std::make_shared<SphereFunction>(VectorXs::Random(nx), 2.),
+      std::make_shared<NegativeOrthant<Scalar>>()));
+  problem->addConstraint(Problem::ConstraintObject(
+      std::make_shared<LinearFunctionTpl<Scalar>>(MatrixXs::Random(3, nx),
+                                                  VectorXs::Random(3)),
+      std::make_shared<NegativeOrthant<Scalar>>()));
+
+  // the lanes run the iterations of the condensed solver
+  Solver solver_cond(problem, 1e-8);
+  solver_cond.hess_approx = HessianApprox::EXACT;
+  BOOST_CHECK_THROW((BatchedSolverTpl<Scalar, 4>(solver_cond)),
+                    std::runtime_error);
+  solver_cond.kkt_system_ = KKT_CONDENSED;
+  solver_cond.max_refinement_steps_ = 0;
+  // the cubic interpolation is not supported
+  BOOST_CHECK_THROW((BatchedSolverTpl<Scalar, 4>(solver_cond)),
+                    std::runtime_error);
+  solver_cond.ls_options.interp_type = LSInterpolation::QUADRATIC;
+
+  BatchedSolverTpl<Scalar, 4> solver(solver_cond);
+  BOOST_CHECK_THROW(solver.solve({}), std::runtime_error);
+  solver.setup();
+  // the lanes only hold evaluation buffers
+  for (const auto &lane : solver.workspace_->lanes) {
+    BOOST_CHECK_EQUAL(lane->ws.kkt_matrix.size(), 0);
+    BOOST_CHECK_EQUAL(lane->ws.kkt_condensed.size(), 0);
+    BOOST_CHECK_EQUAL(lane->ws.qn_hessian.size(), 0);
+  }
+  // two packs, the second one partially filled
+  std::vector<VectorXs> x0s;
+  for (int i = 0; i < 6; i++)
+    x0s.push_back(problem->manifold().rand());
+  const auto flags = solver.solve(x0s);
+  BOOST_CHECK_EQUAL(flags.size(), x0s.size());
+
+  for (std::size_t i = 0; i < x0s.size(); i++) {
+    const auto &res = solver.getResults(i);
+    BOOST_CHECK_EQUAL(flags[i], ConvergenceFlag::SUCCESS);
+    BOOST_CHECK_EQUAL(res.converged, flags[i]);
+    BOOST_CHECK_GT(res.num_iters, 0);
+    BOOST_CHECK_LE(std::max(res.prim_infeas, res.dual_infeas), 1e-8);
+  }
+  // every lane was masked out once done, and the unused lanes of the last
+  // pack were never active
+  const auto &workspace = *solver.workspace_;
+  BOOST_CHECK(!workspace.active.any());
+  BOOST_CHECK(workspace.lanes[1]->results != nullptr);
+  BOOST_CHECK(workspace.lanes[2]->results == nullptr);
+  BOOST_CHECK(workspace.lanes[3]->results == nullptr);
+
+  // a failing lane is masked out without affecting the others
+  x0s[1].setConstant(std::numeric_limits<Scalar>::quiet_NaN());
+  const auto flags_fail = solver.solve(x0s);
+  BOOST_CHECK_EQUAL(flags_fail[1], ConvergenceFlag::FAILED);
+  for (std::size_t i = 0; i < x0s.size(); i++) {
+    if (i != 1)
+      BOOST_CHECK_EQUAL(flags_fail[i], flags[i]);
+  }
+}
+
+/// Problem counting the evaluations of its Lagrangian Hessian.
+struct CountingProblem : Problem {
+  using Problem::Problem;
+  shared_ptr<std::atomic<int>> num_hessians =
+      std::make_shared<std::atomic<int>>(0);
+  void lagrangianHessian(const ConstVectorRef &x, const ConstVectorRef &lams,
+                         Workspace &workspace, MatrixRef Hout,
+                         bool evaluate_all_constraint_hessians) const override {
+    (*num_hessians)++;
+    Problem::lagrangianHessian(x, lams, workspace, Hout,
+                               evaluate_all_constraint_hessians);
+  }
+  shared_ptr<Problem> clone() const override {
+    auto out = std::make_shared<CountingProblem>(*this);
+    out->cloneConstraintSets();
+    return out;
+  }
+};
+
+struct NonCloneableProblem : Problem {
+  using Problem::Problem;
+};
+
+BOOST_AUTO_TEST_CASE(problem_clone) {
+  const int nx = 4;
+  auto base = createEqualityQp(nx, 2);
+  auto clone = base->clone();
+  BOOST_CHECK(typeid(*clone) == typeid(Problem));
+  BOOST_CHECK(clone->getConstraint(0).func_ == base->getConstraint(0).func_);
+  BOOST_CHECK(clone->getConstraint(0).set_ != base->getConstraint(0).set_);
+
+  NonCloneableProblem derived(base->manifold_, base->cost_, base->constraints_);
+  BOOST_CHECK_THROW(derived.clone(), std::runtime_error);
+
+  // the batch workers use the clones, with their overrides
+  auto problem = std::make_shared<CountingProblem>(
+      base->manifold_, base->cost_, base->constraints_);
+  Solver solver(problem, 1e-8);
+  solver.hess_approx = HessianApprox::EXACT;
+  solver.accumulate_hessians_ = true;
+  solver.setBatchNumThreads(1);
+  solver.setup();
+  const auto flags = solver.solveBatch(
+      {problem->manifold().rand(), problem->manifold().rand()});
+  BOOST_CHECK_EQUAL(flags[0], ConvergenceFlag::SUCCESS);
+  BOOST_CHECK_EQUAL(flags[1], ConvergenceFlag::SUCCESS);
+  BOOST_CHECK_GT(*problem->num_hessians, 0);
+}
+
+#ifdef PROXSUITE_NLP_WITH_TIMINGS
+BOOST_AUTO_TEST_CASE(timings) {
+  auto problem = createEqualityQp(8, 3);
+  Solver solver(problem, 1e-8);
+  solver.setup();
+  solver.solve(problem->manifold().neutral());
+
+  const SolverTimings &timings = solver.getResults().timings;
+  BOOST_CHECK_GT(timings.evaluation.count, 0);
+  // each iteration either evaluates the problem with its derivatives, or
+  // reuses the accepted linesearch trial and only computes the derivatives
+  BOOST_CHECK_EQUAL(timings.evaluation.count + timings.derivatives.count,
+                    timings.hessians.count);
+  BOOST_CHECK_GE(timings.factorization.count, timings.refinement.count);
+  BOOST_CHECK_GT(timings.refinement.count, 0);
+  BOOST_CHECK_GE(timings.linesearch.count, timings.refinement.count);
+}
+#endif
+
+#ifdef PROXSUITE_NLP_MULTITHREADING
+BOOST_AUTO_TEST_CASE(multithreaded_evaluation) {
+  const int nx = 6;
+  auto problem = createEqualityQp(nx, 2);
+  for (int i = 0; i < 7; i++) {
+    auto func = std::make_shared<LinearFunctionTpl<Scalar>>(
+        MatrixXs::Random(3, nx), VectorXs::Random(3));
+    problem->addConstraint(Problem::ConstraintObject(
+        func, std::make_shared<EqualityConstraint<Scalar>>()));
+  }
+  WorkspaceTpl<Scalar> ws_serial(*problem);
+  WorkspaceTpl<Scalar> ws_par(*problem);
+  VectorXs x0 = problem->manifold().rand();
+
+  problem->evaluate(x0, ws_serial);
+  problem->computeDerivatives(x0, ws_serial);
+  problem->setNumThreads(4);
+  problem->evaluate(x0, ws_par);
+  problem->computeDerivatives(x0, ws_par);
+
+  BOOST_CHECK(ws_par.data_cstr_values.isApprox(ws_serial.data_cstr_values));
+  BOOST_CHECK(ws_par.data_jacobians.isApprox(ws_serial.data_jacobians));
+
+  // the blocks are dispatched to a team of threads
+  std::vector<int> team_sizes(problem->getNumConstraints(), 0);
+  omp::parallel_for(
+      problem->getNumThreads(), team_sizes.size(),
+      [&](std::size_t i) { team_sizes[i] = omp_get_num_threads(); });
+  for (int size : team_sizes)
+    BOOST_CHECK_EQUAL(size, 4);
+}
+
+BOOST_AUTO_TEST_CASE(multithreaded_linesearch) {
+  const int nx = 6;
+  // the library costs keep their buffers in their data: they can be
+  // evaluated concurrently, as well as the proximal penalty
+  auto problem = createEqualityQp(nx, 1);
+  auto func = std::make_shared<LinearFunctionTpl<Scalar>>(
+      MatrixXs::Random(2, nx), VectorXs::Random(2));
+  problem->addConstraint(Problem::ConstraintObject(
+      func, std::make_shared<NegativeOrthant<Scalar>>()));
+  VectorXs x0 = problem->manifold().neutral();
+
+  Solver solver(problem, 1e-8, 1e-2, 1e-4);
+  solver.setup();
+  BOOST_CHECK_EQUAL(solver.solve(x0), ConvergenceFlag::SUCCESS);
+
+  Solver solver_par(problem, 1e-8, 1e-2, 1e-4);
+  solver_par.setLinesearchNumThreads(4);
+  solver_par.setup();
+  BOOST_CHECK_EQUAL(solver_par.solve(x0), ConvergenceFlag::SUCCESS);
+  BOOST_CHECK(solver_par.getResults().x_opt.isApprox(
+      solver.getResults().x_opt, 1e-6));
+#ifdef PROXSUITE_NLP_EIGEN_CHECK_MALLOC
+  BOOST_CHECK(Eigen::internal::is_malloc_allowed());
+  BOOST_CHECK_EQUAL(internal::nomalloc_depth(), 0);
+#endif
+}
+
+#ifdef PROXSUITE_NLP_EIGEN_CHECK_MALLOC
+BOOST_AUTO_TEST_CASE(multithreaded_nomalloc_state) {
+  // each thread leaves half of its regions early, as when throwing
+  std::vector<char> restored(64, 0);
+  PROXSUITE_NLP_NOMALLOC_BEGIN;
+  omp::parallel_for(4, restored.size(), [&](std::size_t i) {
+    const int depth = internal::nomalloc_depth();
+    {
+      PROXSUITE_NLP_NOMALLOC_STATE_SCOPE;
+      PROXSUITE_NLP_NOMALLOC_BEGIN;
+      {
+        PROXSUITE_NLP_MALLOC_ALLOWED_SCOPE;
+        VectorXs v = VectorXs::Zero(8);
+      }
+      if (i % 2 == 1)
+        PROXSUITE_NLP_NOMALLOC_END;
+    }
+    restored[i] = internal::nomalloc_depth() == depth;
+  });
+  // the caller's region is left as it was
+  BOOST_CHECK(!Eigen::internal::is_malloc_allowed());
+  BOOST_CHECK_EQUAL(internal::nomalloc_depth(), 1);
+  PROXSUITE_NLP_NOMALLOC_END;
+  BOOST_CHECK(Eigen::internal::is_malloc_allowed());
+  BOOST_CHECK_EQUAL(internal::nomalloc_depth(), 0);
+  for (char r : restored)
+    BOOST_CHECK(r);
+}
+#endif
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()